@@ -63,6 +63,7 @@ testScripts=(
     'spentindex.py'
     'decodescript.py'
     'blockchain.py'
+    'utxostatsindex.py'
     'disablewallet.py'
     'zcjoinsplit.py'
     'zcjoinsplitdoublespend.py'
@@ -166,6 +166,7 @@ class AddressIndexTest(BitcoinTestFramework):
         bal = self.nodes[1].getaddressbalance(addr1)
         assert_equal(bal['balance'], expected * COIN)
         assert_equal(bal['received'], expected * COIN)
+        assert_equal(bal['txcount'], len(txids_a1))
         assert_equal(sorted(self.nodes[0].getaddresstxids(addr1)), sorted(txids_a1))
         assert_equal(sorted(self.nodes[1].getaddresstxids(addr1)), sorted(txids_a1))
 
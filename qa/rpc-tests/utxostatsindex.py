@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+# Copyright (c) 2021 The Verus developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#
+# Test that the UTXO set statistics kept by -utxostatsindex as each block is
+# connected match a fresh scan of the coins database, before and after a reorg
+#
+
+import sys; assert sys.version_info < (3,), ur"This script does not run under Python 3. Please use Python 2.7.x."
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    initialize_chain_clean,
+    start_node,
+    start_nodes,
+    stop_node,
+    connect_nodes_bi,
+)
+
+
+class UTXOStatsIndexTest(BitcoinTestFramework):
+
+    def setup_chain(self):
+        print("Initializing test directory "+self.options.tmpdir)
+        initialize_chain_clean(self.options.tmpdir, 2)
+
+    def setup_network(self):
+        # node 0 extends its statistics as each block is connected. node 1 only gets them from a
+        # scan of its coins database, when it is restarted with -utxostatsindex
+        self.nodes = start_nodes(2, self.options.tmpdir, [['-debug', '-utxostatsindex'], ['-debug']])
+        connect_nodes_bi(self.nodes, 0, 1)
+        self.is_network_split = False
+        self.sync_all()
+
+    def restart_node1(self, extra_args):
+        stop_node(self.nodes[1], 1)
+        self.nodes[1] = start_node(1, self.options.tmpdir, ['-debug'] + extra_args)
+        connect_nodes_bi(self.nodes, 0, 1)
+
+    def check_against_scan(self):
+        self.sync_all()
+        self.restart_node1(['-utxostatsindex'])
+
+        connected = self.nodes[0].gettxoutsetinfo('muhash')
+        scanned = self.nodes[1].gettxoutsetinfo('muhash')
+        assert_equal(connected, scanned)
+
+        serialized = self.nodes[0].gettxoutsetinfo()
+        assert_equal(connected['height'], serialized['height'])
+        assert_equal(connected['txouts'], serialized['txouts'])
+        assert_equal(connected['total_amount'], serialized['total_amount'])
+
+        # the blocks node 1 connects next are not added to its statistics, so the next check is against a new scan
+        self.restart_node1([])
+        return connected
+
+    def run_test(self):
+        self.nodes[0].generate(101)
+        self.sync_all()
+        start = self.nodes[0].gettxoutsetinfo('muhash')
+        assert_equal(start['height'], 101)
+
+        address = self.nodes[1].getnewaddress()
+        for i in range(3):
+            self.nodes[0].sendtoaddress(address, 1 + i)
+            self.nodes[0].generate(1)
+        beforeReorg = self.check_against_scan()
+        assert_equal(beforeReorg['height'], 104)
+
+        # node 1 was started at height 104, so it rolls back to earlier heights with the undo data
+        assert_equal(self.nodes[1].gettxoutsetinfo('muhash', 101), start)
+        assert_equal(self.nodes[0].gettxoutsetinfo('muhash', 101), start)
+
+        # replace the last two blocks with three others. their transactions return to the mempool and are mined again
+        kept = self.nodes[0].gettxoutsetinfo('muhash', 102)
+        invalid = self.nodes[0].getblockhash(103)
+        for node in self.nodes:
+            node.invalidateblock(invalid)
+        assert_equal(self.nodes[0].getblockcount(), 102)
+        assert_equal(self.nodes[0].gettxoutsetinfo('muhash'), kept)
+
+        self.nodes[0].sendtoaddress(address, 5)
+        self.nodes[0].generate(3)
+        afterReorg = self.check_against_scan()
+        assert_equal(afterReorg['height'], 105)
+        assert(afterReorg['muhash'] != beforeReorg['muhash'])
+        assert_equal(self.nodes[0].gettxoutsetinfo('muhash', 102), kept)
+
+
+if __name__ == '__main__':
+    UTXOStatsIndexTest().main()
@@ -9,6 +9,10 @@
 #include "uint256.h"
 #include "amount.h"
 #include "script/script.h"
+#include "serialize.h"
+
+#include <limits>
+#include <map>
 
 struct CAddressUnspentKey {
     unsigned int type;
@@ -54,8 +58,166 @@ struct CAddressUnspentKey {
 };
 
 struct CAddressUnspentValue {
+    // leads entries that record where they were confirmed. amounts are never negative, so an
+    // entry written before the marker was added is recognized by its first field alone
+    static const int64_t CONFIRMED_BLOCK_MARKER = std::numeric_limits<int64_t>::min();
+
     CAmount satoshis;
     CScript script;
+    int blockHeight;                // height used for the index, which may be offset for some index keys
+    int confirmedHeight;            // height of the block that confirmed the output, or -1 if not recorded
+    uint256 confirmedBlockHash;     // hash of that block, so callers can check it is still on the active chain
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        if (confirmedHeight >= 0) {
+            ::Serialize(s, CONFIRMED_BLOCK_MARKER);
+        }
+        ::Serialize(s, satoshis);
+        ::Serialize(s, *(CScriptBase*)(&script));
+        ::Serialize(s, blockHeight);
+        if (confirmedHeight >= 0) {
+            ::Serialize(s, confirmedHeight);
+            ::Serialize(s, confirmedBlockHash);
+        }
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        int64_t first;
+        ::Unserialize(s, first);
+        bool hasConfirmed = first == CONFIRMED_BLOCK_MARKER;
+        if (hasConfirmed) {
+            ::Unserialize(s, satoshis);
+        } else {
+            satoshis = first;
+        }
+        ::Unserialize(s, *(CScriptBase*)(&script));
+        ::Unserialize(s, blockHeight);
+        confirmedHeight = -1;
+        confirmedBlockHash.SetNull();
+        if (hasConfirmed) {
+            ::Unserialize(s, confirmedHeight);
+            ::Unserialize(s, confirmedBlockHash);
+        }
+    }
+
+    CAddressUnspentValue(CAmount sats, CScript scriptPubKey, int height, int confirmed=-1, const uint256 &confirmedBlock=uint256()) {
+        satoshis = sats;
+        script = scriptPubKey;
+        blockHeight = height;
+        confirmedHeight = confirmedBlock.IsNull() ? -1 : confirmed;
+        confirmedBlockHash = confirmedBlock;
+    }
+
+    CAddressUnspentValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        satoshis = -1;
+        script.clear();
+        blockHeight = 0;
+        confirmedHeight = -1;
+        confirmedBlockHash.SetNull();
+    }
+
+    bool IsNull() const {
+        return (satoshis == -1);
+    }
+};
+
+// secondary key into the address unspent index by currency, so the unspent outputs of one
+// currency at an address can be found without decoding the script of every output
+struct CAddressUnspentCurrencyKey {
+    unsigned int type;
+    uint160 hashBytes;
+    uint160 currencyID;
+    uint256 txhash;
+    size_t index;
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return 77;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        currencyID.Serialize(s);
+        txhash.Serialize(s);
+        ser_writedata32(s, index);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        currencyID.Unserialize(s);
+        txhash.Unserialize(s);
+        index = ser_readdata32(s);
+    }
+
+    CAddressUnspentCurrencyKey(unsigned int addressType, uint160 addressHash, uint160 currency, uint256 txid, size_t indexValue) {
+        type = addressType;
+        hashBytes = addressHash;
+        currencyID = currency;
+        txhash = txid;
+        index = indexValue;
+    }
+
+    CAddressUnspentCurrencyKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        currencyID.SetNull();
+        txhash.SetNull();
+        index = 0;
+    }
+};
+
+struct CAddressCurrencyIteratorKey {
+    unsigned int type;
+    uint160 hashBytes;
+    uint160 currencyID;
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return 41;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        currencyID.Serialize(s);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        currencyID.Unserialize(s);
+    }
+
+    CAddressCurrencyIteratorKey(unsigned int addressType, uint160 addressHash, uint160 currency) {
+        type = addressType;
+        hashBytes = addressHash;
+        currencyID = currency;
+    }
+
+    CAddressCurrencyIteratorKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        currencyID.SetNull();
+    }
+};
+
+// the native and reserve values of one unspent output, without its script
+struct CAddressUnspentCurrencyValue {
+    CAmount satoshis;
+    std::map<uint160, CAmount> currencyValues;
     int blockHeight;
 
     ADD_SERIALIZE_METHODS;
@@ -63,23 +225,25 @@ struct CAddressUnspentValue {
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
         READWRITE(satoshis);
-        READWRITE(*(CScriptBase*)(&script));
+        READWRITE(currencyValues);
         READWRITE(blockHeight);
     }
 
-    CAddressUnspentValue(CAmount sats, CScript scriptPubKey, int height) {
+    // takes any map of currency IDs to amounts that iterates in currency order
+    template <typename ValueMap>
+    CAddressUnspentCurrencyValue(CAmount sats, const ValueMap &values, int height) :
+        currencyValues(values.begin(), values.end()) {
         satoshis = sats;
-        script = scriptPubKey;
         blockHeight = height;
     }
 
-    CAddressUnspentValue() {
+    CAddressUnspentCurrencyValue() {
         SetNull();
     }
 
     void SetNull() {
         satoshis = -1;
-        script.clear();
+        currencyValues.clear();
         blockHeight = 0;
     }
 
@@ -304,4 +468,90 @@ public:
     }
 };
 
+// running totals for one address, kept up to date as blocks are connected and disconnected
+// so balance queries do not need to walk the address history
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+    int64_t txCount;
+    std::map<uint160, CAmount> currencyBalance;     // reserve currencies, native is in balance and received
+    std::map<uint160, CAmount> currencyReceived;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(balance);
+        READWRITE(received);
+        READWRITE(VARINT(txCount));
+        READWRITE(currencyBalance);
+        READWRITE(currencyReceived);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        txCount = 0;
+        currencyBalance.clear();
+        currencyReceived.clear();
+    }
+
+    bool IsNull() const {
+        return balance == 0 && received == 0 && txCount == 0 && currencyBalance.empty() && currencyReceived.empty();
+    }
+
+    template <typename ValueMap>
+    static void AddCurrencyValues(std::map<uint160, CAmount> &to, const ValueMap &from, int sign)
+    {
+        for (auto &oneValue : from)
+        {
+            CAmount &amount = to[oneValue.first];
+            amount += oneValue.second * sign;
+            if (!amount)
+            {
+                to.erase(oneValue.first);
+            }
+        }
+    }
+
+    // adds or, with a sign of -1, removes the changes in delta
+    void Add(const CAddressBalanceValue &delta, int sign=1)
+    {
+        balance += delta.balance * sign;
+        received += delta.received * sign;
+        txCount += delta.txCount * sign;
+        AddCurrencyValues(currencyBalance, delta.currencyBalance, sign);
+        AddCurrencyValues(currencyReceived, delta.currencyReceived, sign);
+    }
+};
+
+// bounds one read of the address or address unspent index, so callers can walk very large
+// address histories in pages. a read starts at startKey if fStartKey is set, skips offset
+// entries and returns at most limit entries. when entries remain, fMore is set and nextKey
+// is the first one not returned, which resumes the walk when passed back as startKey.
+// offset and limit count down as entries are skipped and returned, so one page can span
+// reads of several addresses.
+template <typename KeyType>
+struct CAddressIndexPage
+{
+    size_t offset;
+    size_t limit;
+    bool fStartKey;
+    KeyType startKey;
+    bool fMore;
+    KeyType nextKey;
+
+    CAddressIndexPage(size_t Offset=0, size_t Limit=SIZE_MAX) : offset(Offset), limit(Limit), fStartKey(false), fMore(false) {}
+
+    void SetStartKey(const KeyType &key)
+    {
+        fStartKey = true;
+        startKey = key;
+    }
+};
+
 #endif // BITCOIN_ADDRESSINDEX_H
@@ -26,6 +26,7 @@
 #include "zcash/IncrementalMerkleTree.hpp"
 #include "veruslaunch.h"
 #include "pbaas/reserves.h"
+#include "utxostatsindex.h"
 
 /** 
  * Pruned version of CTransaction: only retains metadata and unspent transaction outputs
@@ -349,8 +350,10 @@ struct CCoinsStats
     uint64_t nSerializedSize;
     uint256 hashSerialized;
     CAmount nTotalAmount;
+    bool fUTXOStats;                    // set by the caller to also compute utxoStats, which is slower
+    CUTXOStatsIndexValue utxoStats;     // per output statistics, in the form kept by the UTXO stats index
 
-    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nSerializedSize(0), nTotalAmount(0) {}
+    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nSerializedSize(0), nTotalAmount(0), fUTXOStats(false) {}
 };
 
 
@@ -569,6 +572,13 @@ public:
      */
     bool Flush();
 
+    /**
+     * Removes the transaction with the given hash from the cache, if it is
+     * not modified. Used to release coins that were only loaded to validate
+     * transactions that have since left the memory pool.
+     */
+    void Uncache(const uint256 &txid);
+
     //! Calculate the size of the cache (in number of transactions)
     unsigned int GetCacheSize() const;
 
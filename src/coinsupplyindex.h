@@ -0,0 +1,56 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_COINSUPPLYINDEX_H
+#define BITCOIN_COINSUPPLYINDEX_H
+
+#include "amount.h"
+#include "serialize.h"
+
+#include <map>
+
+// the coin supply as of a block, keyed by block hash, with running totals carried forward from its parent,
+// so the supply at any height of the active chain is a single point lookup rather than a walk from height 1
+struct CCoinSupplyIndexValue {
+    int64_t newCoins;               // change in transparent supply in this block
+    int64_t immature;               // coinbase amount in this block that is not spendable until maturity
+    uint32_t maturity;              // height at which that amount matures
+    int64_t chainSupply;            // transparent supply up to and including this block
+    int64_t chainZFunds;            // shielded supply up to and including this block
+    int64_t chainImmature;          // coinbase amounts of this and prior blocks that have not yet matured
+    std::map<uint32_t, int64_t> timeLocked; // unmatured amounts locked past the normal maturity, by maturity height
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(newCoins);
+        READWRITE(immature);
+        READWRITE(maturity);
+        READWRITE(chainSupply);
+        READWRITE(chainZFunds);
+        READWRITE(chainImmature);
+        READWRITE(timeLocked);
+    }
+
+    CCoinSupplyIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        newCoins = 0;
+        immature = 0;
+        maturity = 0;
+        chainSupply = 0;
+        chainZFunds = 0;
+        chainImmature = 0;
+        timeLocked.clear();
+    }
+
+    bool IsNull() const {
+        return maturity == 0;
+    }
+};
+
+#endif // BITCOIN_COINSUPPLYINDEX_H
@@ -449,30 +449,21 @@ CAmount CCurrencyState::PriceInReserve(int32_t reserveIndex, bool roundUp) const
     {
         return weights[reserveIndex];
     }
-    arith_uint256 Supply(supply);
-    arith_uint256 Reserve(reserves[reserveIndex] ? reserves[reserveIndex] : SATOSHIDEN);
-    arith_uint256 Ratio(weights[reserveIndex]);
-    static arith_uint256 bigZero(0);
-    static arith_uint256 BigSatoshi(SATOSHIDEN);
-    static arith_uint256 BigSatoshiSquared = BigSatoshi * BigSatoshi;
+    // both products fit in 128 bits, so this matches the former arith_uint256 calculation exactly
+    unsigned __int128 numerator = (unsigned __int128)(uint64_t)(reserves[reserveIndex] ? reserves[reserveIndex] : SATOSHIDEN) *
+                                  (uint64_t)(SATOSHIDEN * SATOSHIDEN);
+    unsigned __int128 denominator = (unsigned __int128)(uint64_t)supply * (uint64_t)weights[reserveIndex];
+    CAmount answer = (uint64_t)(numerator / denominator);
 
     if (roundUp)
     {
-        arith_uint256 denominator = Supply * Ratio;
-        arith_uint256 numerator = Reserve * BigSatoshiSquared;
-        arith_uint256 bigAnswer = numerator / denominator;
-        int64_t remainder = (numerator - (bigAnswer * denominator)).GetLow64();
-        CAmount answer = bigAnswer.GetLow64();
+        int64_t remainder = (uint64_t)(numerator % denominator);
         if (remainder && (answer + 1) > 0)
         {
             answer++;
         }
-        return answer;
-    }
-    else
-    {
-        return ((Reserve * BigSatoshiSquared) / (Supply * Ratio)).GetLow64();
     }
+    return answer;
 }
 
 cpp_dec_float_50 CCurrencyState::PriceInReserveDecFloat50(int32_t reserveIndex) const
@@ -497,6 +488,36 @@ cpp_dec_float_50 CCurrencyState::PriceInReserveDecFloat50(int32_t reserveIndex)
     return (Reserve * BigSatoshiSquared) / (Supply * Ratio);
 }
 
+CAmount CCurrencyState::PriceInReserveTruncated(int32_t reserveIndex) const
+{
+    if (reserveIndex >= reserves.size())
+    {
+        return 0;
+    }
+    if (!IsFractional())
+    {
+        return reserves[reserveIndex];
+    }
+    if (!supply || weights[reserveIndex] == 0)
+    {
+        return weights[reserveIndex];
+    }
+
+    // magnitudes are below 2^117 and 2^95, so neither product can overflow
+    __int128 numerator = (__int128)(reserves[reserveIndex] ? reserves[reserveIndex] : SATOSHIDEN) * (SATOSHIDEN * SATOSHIDEN);
+    __int128 denominator = (__int128)supply * weights[reserveIndex];
+    bool negative = (numerator < 0) != (denominator < 0);
+    unsigned __int128 quotient = (numerator < 0 ? -(unsigned __int128)numerator : (unsigned __int128)numerator) /
+                                 (denominator < 0 ? -(unsigned __int128)denominator : (unsigned __int128)denominator);
+
+    // to_int64 stops at the decimal point and saturates out of range values
+    if (negative)
+    {
+        return quotient > (unsigned __int128)INT64_MAX + 1 ? INT64_MIN : (CAmount)-(__int128)quotient;
+    }
+    return quotient > INT64_MAX ? INT64_MAX : (CAmount)quotient;
+}
+
 std::vector<CAmount> CCurrencyState::PricesInReserve(bool roundUp) const
 {
     std::vector<CAmount> retVal(currencies.size());
@@ -526,15 +547,10 @@ CAmount CCurrencyState::ReserveToNativeRaw(CAmount reserveAmount, CAmount exchan
 {
     //return ReserveToNativeRaw(reserveAmount, cpp_dec_float_50(std::to_string(exchangeRate)));
 
-    static arith_uint256 bigSatoshi(SATOSHIDEN);
-    static arith_uint256 bigZero(0);
-    arith_uint256 bigAmount(reserveAmount);
-
-    arith_uint256 bigRetVal = (exchangeRate != bigZero ? (bigAmount * bigSatoshi) / exchangeRate : bigZero);
-    int64_t retVal = bigRetVal.GetLow64();
-    if ((bigRetVal - retVal) == 0)
+    unsigned __int128 bigRetVal = exchangeRate ? MultiplyDivide(reserveAmount, SATOSHIDEN, exchangeRate) : 0;
+    if (!(bigRetVal >> 64))
     {
-        return retVal;
+        return (uint64_t)bigRetVal;
     }
     else
     {
@@ -611,13 +627,11 @@ CAmount CCurrencyState::NativeToReserveRaw(CAmount nativeAmount, CAmount exchang
 {
     //return NativeToReserveRaw(nativeAmount, cpp_dec_float_50(std::to_string(exchangeRate)));
 
-    static arith_uint256 bigSatoshi(SATOSHIDEN);
-    arith_uint256 bigAmount(nativeAmount);
-    arith_uint256 bigReserves = (bigAmount * exchangeRate) / bigSatoshi;
-    int64_t retVal = bigReserves.GetLow64();
-    if ((bigReserves - retVal) == 0)
+    // the rate is taken as uint32_t here, as it was by arith_uint256
+    unsigned __int128 bigReserves = MultiplyDivide(nativeAmount, (uint32_t)exchangeRate, SATOSHIDEN);
+    if (!(bigReserves >> 64))
     {
-        return retVal;
+        return (uint64_t)bigReserves;
     }
     else
     {
@@ -633,13 +647,11 @@ CAmount CCurrencyState::NativeGasToReserveRaw(CAmount nativeAmount, CAmount exch
         return nativeAmount;
     }
     exchangeRate = exchangeRate / (SATOSHIDEN / 100);
-    static arith_uint256 bigSatoshiX1000(SATOSHIDEN * 1000);
-    arith_uint256 bigAmount(nativeAmount);
-    arith_uint256 bigReserves = (bigAmount * exchangeRate) / bigSatoshiX1000;
-    int64_t retVal = bigReserves.GetLow64();
-    if ((bigReserves - retVal) == 0)
+    // the rate is taken as uint32_t here, as it was by arith_uint256
+    unsigned __int128 bigReserves = MultiplyDivide(nativeAmount, (uint32_t)exchangeRate, SATOSHIDEN * 1000);
+    if (!(bigReserves >> 64))
     {
-        return retVal;
+        return (uint64_t)bigReserves;
     }
     else
     {
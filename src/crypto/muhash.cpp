@@ -0,0 +1,186 @@
+// Copyright (c) 2017-2020 The Bitcoin Core developers
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "crypto/muhash.h"
+
+#include "crypto/chacha20.h"
+#include "crypto/common.h"
+#include "crypto/sha256.h"
+
+typedef unsigned __int128 uint128_t;
+
+Num3072::Num3072(const unsigned char (&data)[BYTE_SIZE])
+{
+    for (int i = 0; i < LIMBS; i++) {
+        limbs[i] = ReadLE64(data + 8 * i);
+    }
+    if (IsOverflow()) {
+        FullReduce();
+    }
+}
+
+void Num3072::SetToOne()
+{
+    limbs[0] = 1;
+    for (int i = 1; i < LIMBS; i++) {
+        limbs[i] = 0;
+    }
+}
+
+void Num3072::ToBytes(unsigned char (&out)[BYTE_SIZE]) const
+{
+    for (int i = 0; i < LIMBS; i++) {
+        WriteLE64(out + 8 * i, limbs[i]);
+    }
+}
+
+/* Whether the value, which is below 2^3072, is at or above the modulus. */
+bool Num3072::IsOverflow() const
+{
+    if (limbs[0] < ~uint64_t(0) - MAX_PRIME_DIFF + 1) {
+        return false;
+    }
+    for (int i = 1; i < LIMBS; i++) {
+        if (limbs[i] != ~uint64_t(0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Subtract the modulus once, which is adding MAX_PRIME_DIFF and dropping the carry out of the top limb. */
+void Num3072::FullReduce()
+{
+    uint64_t carry = MAX_PRIME_DIFF;
+    for (int i = 0; i < LIMBS && carry; i++) {
+        limbs[i] += carry;
+        carry = limbs[i] < carry ? 1 : 0;
+    }
+}
+
+void Num3072::Multiply(const Num3072& a)
+{
+    // full 6144 bit product. a may be *this, so limbs are only written once it is done
+    uint64_t product[2 * LIMBS] = {0};
+    for (int i = 0; i < LIMBS; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < LIMBS; j++) {
+            uint128_t t = (uint128_t)limbs[i] * a.limbs[j] + product[i + j] + carry;
+            product[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        product[i + LIMBS] = carry;
+    }
+
+    // 2^3072 is MAX_PRIME_DIFF modulo the prime, so fold the high half in as high * MAX_PRIME_DIFF + low
+    uint64_t carry = 0;
+    for (int i = 0; i < LIMBS; i++) {
+        uint128_t t = (uint128_t)product[i + LIMBS] * MAX_PRIME_DIFF + product[i] + carry;
+        limbs[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+
+    // the carry is below 2^21, fold it in the same way. if that wraps past 2^3072, the result is tiny and
+    // folding the wrap in once more cannot wrap again
+    uint64_t add = carry * MAX_PRIME_DIFF;
+    for (int i = 0; i < LIMBS && add; i++) {
+        limbs[i] += add;
+        add = limbs[i] < add ? 1 : 0;
+    }
+    if (add) {
+        add = MAX_PRIME_DIFF;
+        for (int i = 0; i < LIMBS && add; i++) {
+            limbs[i] += add;
+            add = limbs[i] < add ? 1 : 0;
+        }
+    }
+
+    if (IsOverflow()) {
+        FullReduce();
+    }
+}
+
+/* The inverse by Fermat's little theorem, as this raised to the power of the prime minus 2, with a 4 bit window. */
+Num3072 Num3072::GetInverse() const
+{
+    Num3072 powers[16];
+    powers[1] = *this;
+    for (int i = 2; i < 16; i++) {
+        powers[i] = powers[i - 1];
+        powers[i].Multiply(*this);
+    }
+
+    Num3072 out;
+    for (int i = LIMBS - 1; i >= 0; i--) {
+        // every limb of the prime minus 2 is all ones, except the lowest
+        uint64_t exponent = i ? ~uint64_t(0) : ~uint64_t(0) - MAX_PRIME_DIFF - 1;
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            for (int j = 0; j < 4; j++) {
+                out.Multiply(out);
+            }
+            int window = (exponent >> shift) & 15;
+            if (window) {
+                out.Multiply(powers[window]);
+            }
+        }
+    }
+    return out;
+}
+
+void Num3072::Divide(const Num3072& a)
+{
+    Multiply(a.GetInverse());
+}
+
+Num3072 MuHash3072::ToNum3072(const unsigned char* data, size_t len)
+{
+    unsigned char hash[CSHA256::OUTPUT_SIZE];
+    CSHA256().Write(data, len).Finalize(hash);
+
+    unsigned char expanded[Num3072::BYTE_SIZE];
+    ChaCha20(hash, sizeof(hash)).Output(expanded, sizeof(expanded));
+    return Num3072(expanded);
+}
+
+MuHash3072::MuHash3072(const unsigned char* data, size_t len)
+{
+    numerator = ToNum3072(data, len);
+}
+
+MuHash3072& MuHash3072::Insert(const unsigned char* data, size_t len)
+{
+    numerator.Multiply(ToNum3072(data, len));
+    return *this;
+}
+
+MuHash3072& MuHash3072::Remove(const unsigned char* data, size_t len)
+{
+    denominator.Multiply(ToNum3072(data, len));
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator*=(const MuHash3072& mul)
+{
+    numerator.Multiply(mul.numerator);
+    denominator.Multiply(mul.denominator);
+    return *this;
+}
+
+MuHash3072& MuHash3072::operator/=(const MuHash3072& div)
+{
+    numerator.Multiply(div.denominator);
+    denominator.Multiply(div.numerator);
+    return *this;
+}
+
+void MuHash3072::Finalize(uint256& out)
+{
+    numerator.Divide(denominator);
+    denominator.SetToOne();
+
+    unsigned char data[Num3072::BYTE_SIZE];
+    numerator.ToBytes(data);
+    CSHA256().Write(data, sizeof(data)).Finalize(out.begin());
+}
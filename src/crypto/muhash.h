@@ -0,0 +1,89 @@
+// Copyright (c) 2017-2020 The Bitcoin Core developers
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_CRYPTO_MUHASH_H
+#define BITCOIN_CRYPTO_MUHASH_H
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** A number modulo the prime 2^3072 - 1103717, in 64 bit little endian limbs. */
+class Num3072
+{
+private:
+    void FullReduce();
+    bool IsOverflow() const;
+    Num3072 GetInverse() const;
+
+public:
+    static const size_t BYTE_SIZE = 384;
+    static const int LIMBS = 48;
+    static const uint64_t MAX_PRIME_DIFF = 1103717;
+
+    uint64_t limbs[LIMBS];
+
+    Num3072() { SetToOne(); }
+    Num3072(const unsigned char (&data)[BYTE_SIZE]);
+
+    void SetToOne();
+    void Multiply(const Num3072& a);
+    void Divide(const Num3072& a);
+    void ToBytes(unsigned char (&out)[BYTE_SIZE]) const;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        for (int i = 0; i < LIMBS; i++) {
+            READWRITE(limbs[i]);
+        }
+    }
+};
+
+/** A hash of a multiset of byte strings, which can be updated incrementally in any order.
+ *
+ * Each element is hashed to a number modulo a 3072 bit prime, and the set hash is the product of
+ * the numbers of its elements, so inserting multiplies and removing divides. To keep updates cheap,
+ * removed elements are multiplied into a separate denominator, and the one modular inversion is
+ * only done in Finalize. Two instances can be combined with *= and /=, so the hash of a set can be
+ * kept as the running product of the changes made to it.
+ */
+class MuHash3072
+{
+private:
+    Num3072 numerator;
+    Num3072 denominator;
+
+    static Num3072 ToNum3072(const unsigned char* data, size_t len);
+
+public:
+    /* The empty set. */
+    MuHash3072() {}
+
+    /* A set containing a single element. */
+    MuHash3072(const unsigned char* data, size_t len);
+
+    MuHash3072& Insert(const unsigned char* data, size_t len);
+    MuHash3072& Remove(const unsigned char* data, size_t len);
+
+    MuHash3072& operator*=(const MuHash3072& mul);
+    MuHash3072& operator/=(const MuHash3072& div);
+
+    /* The 256 bit hash of the set. This folds the denominator into the numerator, which is slow. */
+    void Finalize(uint256& out);
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(numerator);
+        READWRITE(denominator);
+    }
+};
+
+#endif // BITCOIN_CRYPTO_MUHASH_H
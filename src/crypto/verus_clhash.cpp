@@ -40,6 +40,7 @@ int __cpuverusoptimized = 0x80;
 
 thread_local thread_specific_ptr verusclhasher_key;
 thread_local thread_specific_ptr verusclhasher_descr;
+thread_local thread_specific_ptr verusclhasher_lanes;
 
 #if defined(__APPLE__) || defined(_WIN32)
 // attempt to workaround horrible mingw/gcc destructor bug on Windows and Mac, which passes garbage in the this pointer
@@ -54,6 +55,10 @@ thread_specific_ptr::~thread_specific_ptr() {
     {
         verusclhasher_descr.reset();
     }
+    if (verusclhasher_lanes.ptr)
+    {
+        verusclhasher_lanes.reset();
+    }
 }
 #endif // defined(__APPLE__) || defined(_WIN32)
 #if defined(__arm__)  || defined(__aarch64__) //intrinsics not defined in SSE2NEON.h
@@ -881,289 +886,582 @@ __m128i __verusclmulwithoutreduction64alignedrepeat_sv2_1(__m128i *randomsource,
     return acc;
 }
 
-__m128i __verusclmulwithoutreduction64alignedrepeat_sv2_2(__m128i *randomsource, const __m128i buf[4], uint64_t keyMask, __m128i **pMoveScratch)
+// one of the 32 mutating rounds of the VerusHash 2.2 intermediate hash, which records the two key locations
+// it mutates in pMoveScratch[0] and pMoveScratch[1]
+static inline __attribute__((always_inline)) __m128i verusclmul_sv2_2_round(__m128i acc, __m128i *randomsource, const __m128i *pbuf_copy, uint64_t keyMask, __m128i **pMoveScratch)
 {
-    const __m128i pbuf_copy[4] = {_mm_xor_si128(buf[0], buf[2]), _mm_xor_si128(buf[1], buf[3]), buf[2], buf[3]};
     const __m128i *pbuf;
 
-    // divide key mask by 16 from bytes to __m128i
-    keyMask >>= 4;
-
-    // the random buffer must have at least 32 16 byte dwords after the keymask to work with this
-    // algorithm. we take the value from the last element inside the keyMask + 2, as that will never
-    // be used to xor into the accumulator before it is hashed with other values first
-    __m128i acc = _mm_load_si128(randomsource + (keyMask + 2));
-
-    for (int64_t i = 0; i < 32; i++)
-    {
-        const uint64_t selector = _mm_cvtsi128_si64(acc);
+    const uint64_t selector = _mm_cvtsi128_si64(acc);
 
-        // get two random locations in the key, which will be mutated and swapped
-        __m128i *prand = randomsource + ((selector >> 5) & keyMask);
-        __m128i *prandex = randomsource + ((selector >> 32) & keyMask);
+    // get two random locations in the key, which will be mutated and swapped
+    __m128i *prand = randomsource + ((selector >> 5) & keyMask);
+    __m128i *prandex = randomsource + ((selector >> 32) & keyMask);
 
-        *(pMoveScratch++) = prand;
-        *(pMoveScratch++) = prandex;        
+    pMoveScratch[0] = prand;
+    pMoveScratch[1] = prandex;
 
-        // select random start and order of pbuf processing
-        pbuf = pbuf_copy + (selector & 3);
+    // select random start and order of pbuf processing
+    pbuf = pbuf_copy + (selector & 3);
 
-        switch (selector & 0x1c)
+    switch (selector & 0x1c)
+    {
+        case 0:
         {
-            case 0:
-            {
-                const __m128i temp1 = _mm_load_si128(prandex);
-                const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
-
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            const __m128i temp1 = _mm_load_si128(prandex);
+            const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf);
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+            acc = _mm_xor_si128(clprod12, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+        case 4:
+        {
+            const __m128i temp1 = _mm_load_si128(prand);
+            const __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+            const __m128i clprod2 = _mm_clmulepi64_si128(temp2, temp2, 0x10);
+            acc = _mm_xor_si128(clprod2, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            acc = _mm_xor_si128(add12, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prand, tempb2);
+            break;
+        }
+        case 8:
+        {
+            const __m128i temp1 = _mm_load_si128(prandex);
+            const __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            acc = _mm_xor_si128(add1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+            acc = _mm_xor_si128(clprod12, acc);
+            const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
+            acc = _mm_xor_si128(clprod22, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+        case 0xc:
+        {
+            const __m128i temp1 = _mm_load_si128(prand);
+            const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
 
-                const __m128i temp12 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+            // cannot be zero here
+            const int32_t divisor = (uint32_t)selector;
 
-                const __m128i temp22 = _mm_load_si128(pbuf);
-                const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                acc = _mm_xor_si128(clprod12, acc);
+            acc = _mm_xor_si128(add1, acc);
 
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                _mm_store_si128(prandex, tempb2);
-                break;
-            }
-            case 4:
-            {
-                const __m128i temp1 = _mm_load_si128(prand);
-                const __m128i temp2 = _mm_load_si128(pbuf);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
-                const __m128i clprod2 = _mm_clmulepi64_si128(temp2, temp2, 0x10);
-                acc = _mm_xor_si128(clprod2, acc);
+            const int64_t dividend = _mm_cvtsi128_si64(acc);
+            const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
+            acc = _mm_xor_si128(modulo, acc);
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
 
+            if (dividend & 1)
+            {
                 const __m128i temp12 = _mm_load_si128(prandex);
                 _mm_store_si128(prandex, tempa2);
 
-                const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+                const __m128i temp22 = _mm_load_si128(pbuf);
                 const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                acc = _mm_xor_si128(add12, acc);
+                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+                acc = _mm_xor_si128(clprod12, acc);
+                const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
+                acc = _mm_xor_si128(clprod22, acc);
 
                 const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
                 const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
                 _mm_store_si128(prand, tempb2);
-                break;
             }
-            case 8:
+            else
             {
-                const __m128i temp1 = _mm_load_si128(prandex);
-                const __m128i temp2 = _mm_load_si128(pbuf);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                acc = _mm_xor_si128(add1, acc);
+                const __m128i tempb3 = _mm_load_si128(prandex);
+                _mm_store_si128(prandex, tempa2);
+                _mm_store_si128(prand, tempb3);
+                const __m128i tempb4 = _mm_load_si128(pbuf);
+                acc = _mm_xor_si128(tempb4, acc);
+            }
+            break;
+        }
+        case 0x10:
+        {
+            // a few AES operations
+            const __m128i *rc = prand;
+            __m128i tmp;
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            __m128i temp1 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            __m128i temp2 = _mm_load_si128(pbuf);
 
-                const __m128i temp12 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+            AES2(temp1, temp2, 0);
+            MIX2(temp1, temp2);
 
-                const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                acc = _mm_xor_si128(clprod12, acc);
-                const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
-                acc = _mm_xor_si128(clprod22, acc);
+            AES2(temp1, temp2, 4);
+            MIX2(temp1, temp2);
 
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                _mm_store_si128(prandex, tempb2);
-                break;
-            }
-            case 0xc:
-            {
-                const __m128i temp1 = _mm_load_si128(prand);
-                const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            AES2(temp1, temp2, 8);
+            MIX2(temp1, temp2);
 
-                // cannot be zero here
-                const int32_t divisor = (uint32_t)selector;
+            acc = _mm_xor_si128(temp2, _mm_xor_si128(temp1, acc));
 
-                acc = _mm_xor_si128(add1, acc);
+            const __m128i tempa1 = _mm_load_si128(prand);
+            const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
+            const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
 
-                const int64_t dividend = _mm_cvtsi128_si64(acc);
-                const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
-                acc = _mm_xor_si128(modulo, acc);
+            const __m128i tempa4 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa3);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x14:
+        {
+            // we'll just call this one the monkins loop, inspired by Chris - modified to cast to uint64_t on shift for more variability in the loop
+            const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
+            __m128i tmp; // used by MIX2
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
+            __m128i *rc = prand;
+            uint64_t aesroundoffset = 0;
+            __m128i onekey;
 
-                if (dividend & 1)
+            do
+            {
+                if (selector & (((uint64_t)0x10000000) << rounds))
                 {
-                    const __m128i temp12 = _mm_load_si128(prandex);
-                    _mm_store_si128(prandex, tempa2);
+                    onekey = _mm_load_si128(rc++);
+                    const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
+                    const __m128i add1 = _mm_xor_si128(onekey, temp2);
+                    const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+                    acc = _mm_xor_si128(clprod1, acc);
+                }
+                else
+                {
+                    onekey = _mm_load_si128(rc++);
+                    __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
+                    AES2(onekey, temp2, aesroundoffset);
+                    aesroundoffset += 4;
+                    MIX2(onekey, temp2);
+                    acc = _mm_xor_si128(onekey, acc);
+                    acc = _mm_xor_si128(temp2, acc);
+                }
+            } while (rounds--);
 
-                    const __m128i temp22 = _mm_load_si128(pbuf);
-                    const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                    const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                    acc = _mm_xor_si128(clprod12, acc);
-                    const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
-                    acc = _mm_xor_si128(clprod22, acc);
+            const __m128i tempa1 = _mm_load_si128(prand);
+            const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
+            const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
 
-                    const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                    const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                    _mm_store_si128(prand, tempb2);
+            const __m128i tempa4 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa3);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x18:
+        {
+            const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
+            __m128i tmp; // used by MIX2
+
+            uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
+            __m128i *rc = prand;
+            __m128i onekey;
+
+            do
+            {
+                if (selector & (((uint64_t)0x10000000) << rounds))
+                {
+                    onekey = _mm_load_si128(rc++);
+                    const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
+                    onekey = _mm_xor_si128(onekey, temp2);
+                    // cannot be zero here, may be negative
+                    const int32_t divisor = (uint32_t)selector;
+                    const int64_t dividend = _mm_cvtsi128_si64(onekey);
+                    const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
+                    acc = _mm_xor_si128(modulo, acc);
                 }
                 else
                 {
-                    const __m128i tempb3 = _mm_load_si128(prandex);
-                    _mm_store_si128(prandex, tempa2);
-                    _mm_store_si128(prand, tempb3);
-                    const __m128i tempb4 = _mm_load_si128(pbuf);
-                    acc = _mm_xor_si128(tempb4, acc);
+                    onekey = _mm_load_si128(rc++);
+                    __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
+                    const __m128i add1 = _mm_xor_si128(onekey, temp2);
+                    onekey = _mm_clmulepi64_si128(add1, add1, 0x10);
+                    const __m128i clprod2 = _mm_mulhrs_epi16(acc, onekey);
+                    acc = _mm_xor_si128(clprod2, acc);
                 }
-                break;
-            }
-            case 0x10:
-            {
-                // a few AES operations
-                const __m128i *rc = prand;
-                __m128i tmp;
+            } while (rounds--);
 
-                __m128i temp1 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i tempa3 = _mm_load_si128(prandex);
+            const __m128i tempa4 = _mm_xor_si128(tempa3, acc);
 
-                AES2(temp1, temp2, 0);
-                MIX2(temp1, temp2);
+            _mm_store_si128(prandex, onekey);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x1c:
+        {
+            const __m128i temp1 = _mm_load_si128(pbuf);
+            const __m128i temp2 = _mm_load_si128(prandex);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp2);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp2);
+
+            const __m128i tempa3 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            acc = _mm_xor_si128(tempa3, acc);
+            const __m128i temp4 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1)); 
+            acc = _mm_xor_si128(temp4,acc);  
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, tempa3);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, tempa3);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+    }
+    return acc;
+}
 
-                AES2(temp1, temp2, 4);
-                MIX2(temp1, temp2);
+__m128i __verusclmulwithoutreduction64alignedrepeat_sv2_2(__m128i *randomsource, const __m128i buf[4], uint64_t keyMask, __m128i **pMoveScratch)
+{
+    const __m128i pbuf_copy[4] = {_mm_xor_si128(buf[0], buf[2]), _mm_xor_si128(buf[1], buf[3]), buf[2], buf[3]};
 
-                AES2(temp1, temp2, 8);
-                MIX2(temp1, temp2);
+    // divide key mask by 16 from bytes to __m128i
+    keyMask >>= 4;
 
-                acc = _mm_xor_si128(temp2, _mm_xor_si128(temp1, acc));
+    // the random buffer must have at least 32 16 byte dwords after the keymask to work with this
+    // algorithm. we take the value from the last element inside the keyMask + 2, as that will never
+    // be used to xor into the accumulator before it is hashed with other values first
+    __m128i acc = _mm_load_si128(randomsource + (keyMask + 2));
 
-                const __m128i tempa1 = _mm_load_si128(prand);
-                const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
-                const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
+    for (int64_t i = 0; i < 32; i++)
+    {
+        acc = verusclmul_sv2_2_round(acc, randomsource, pbuf_copy, keyMask, pMoveScratch + (i << 1));
+    }
+    return acc;
+}
 
-                const __m128i tempa4 = _mm_load_si128(prandex);
-                _mm_store_si128(prandex, tempa3);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x14:
-            {
-                // we'll just call this one the monkins loop, inspired by Chris - modified to cast to uint64_t on shift for more variability in the loop
-                const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
-                __m128i tmp; // used by MIX2
+// the same as __verusclmulwithoutreduction64alignedrepeat_sv2_2 for LANES independent buffers and keys, with the rounds
+// of all lanes interleaved so that their dependency chains can execute in parallel
+template <int LANES>
+static inline __attribute__((always_inline)) void __verusclmulwithoutreduction64alignedrepeat_sv2_2_lanes(__m128i acc[LANES], __m128i *randomsource[LANES], const __m128i *buf[LANES], uint64_t keyMask, __m128i **pMoveScratch[LANES])
+{
+    __m128i pbuf_copy[LANES][4];
 
-                uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
-                __m128i *rc = prand;
-                uint64_t aesroundoffset = 0;
-                __m128i onekey;
+    // divide key mask by 16 from bytes to __m128i
+    keyMask >>= 4;
 
-                do
-                {
-                    if (selector & (((uint64_t)0x10000000) << rounds))
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
-                        const __m128i add1 = _mm_xor_si128(onekey, temp2);
-                        const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                        acc = _mm_xor_si128(clprod1, acc);
-                    }
-                    else
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
-                        AES2(onekey, temp2, aesroundoffset);
-                        aesroundoffset += 4;
-                        MIX2(onekey, temp2);
-                        acc = _mm_xor_si128(onekey, acc);
-                        acc = _mm_xor_si128(temp2, acc);
-                    }
-                } while (rounds--);
+    for (int l = 0; l < LANES; l++)
+    {
+        pbuf_copy[l][0] = _mm_xor_si128(buf[l][0], buf[l][2]);
+        pbuf_copy[l][1] = _mm_xor_si128(buf[l][1], buf[l][3]);
+        pbuf_copy[l][2] = buf[l][2];
+        pbuf_copy[l][3] = buf[l][3];
+        acc[l] = _mm_load_si128(randomsource[l] + (keyMask + 2));
+    }
 
-                const __m128i tempa1 = _mm_load_si128(prand);
-                const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
-                const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
+    for (int64_t i = 0; i < 32; i++)
+    {
+        for (int l = 0; l < LANES; l++)
+        {
+            acc[l] = verusclmul_sv2_2_round(acc[l], randomsource[l], pbuf_copy[l], keyMask, pMoveScratch[l] + (i << 1));
+        }
+    }
+}
 
-                const __m128i tempa4 = _mm_load_si128(prandex);
-                _mm_store_si128(prandex, tempa3);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x18:
-            {
-                const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
-                __m128i tmp; // used by MIX2
+// runs the keyed Haraka512 finalization for LANES independent buffers, interleaving the AES rounds of all lanes
+// so that the latency of each aesenc is hidden behind the others
+template <int LANES>
+static inline __attribute__((always_inline)) void haraka512_keyed_lanes(unsigned char *out[LANES], unsigned char *in[LANES], const u128 *keys[LANES])
+{
+    u128 s[LANES][4], tmp;
 
-                uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
-                __m128i *rc = prand;
-                __m128i onekey;
+    for (int l = 0; l < LANES; l++)
+    {
+        s[l][0] = LOAD(in[l]);
+        s[l][1] = LOAD(in[l] + 16);
+        s[l][2] = LOAD(in[l] + 32);
+        s[l][3] = LOAD(in[l] + 48);
+    }
 
-                do
-                {
-                    if (selector & (((uint64_t)0x10000000) << rounds))
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
-                        onekey = _mm_xor_si128(onekey, temp2);
-                        // cannot be zero here, may be negative
-                        const int32_t divisor = (uint32_t)selector;
-                        const int64_t dividend = _mm_cvtsi128_si64(onekey);
-                        const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
-                        acc = _mm_xor_si128(modulo, acc);
-                    }
-                    else
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
-                        const __m128i add1 = _mm_xor_si128(onekey, temp2);
-                        onekey = _mm_clmulepi64_si128(add1, add1, 0x10);
-                        const __m128i clprod2 = _mm_mulhrs_epi16(acc, onekey);
-                        acc = _mm_xor_si128(clprod2, acc);
-                    }
-                } while (rounds--);
+    for (int r = 0; r < 40; r += 8)
+    {
+        for (int l = 0; l < LANES; l++)
+        {
+            const u128 *rc = keys[l];
+            AES4(s[l][0], s[l][1], s[l][2], s[l][3], r);
+        }
+        for (int l = 0; l < LANES; l++)
+        {
+            MIX4(s[l][0], s[l][1], s[l][2], s[l][3]);
+        }
+    }
 
-                const __m128i tempa3 = _mm_load_si128(prandex);
-                const __m128i tempa4 = _mm_xor_si128(tempa3, acc);
+    for (int l = 0; l < LANES; l++)
+    {
+        s[l][0] = _mm_xor_si128(s[l][0], LOAD(in[l]));
+        s[l][1] = _mm_xor_si128(s[l][1], LOAD(in[l] + 16));
+        s[l][2] = _mm_xor_si128(s[l][2], LOAD(in[l] + 32));
+        s[l][3] = _mm_xor_si128(s[l][3], LOAD(in[l] + 48));
+        TRUNCSTORE(out[l], s[l][0], s[l][1], s[l][2], s[l][3]);
+    }
+}
 
-                _mm_store_si128(prandex, onekey);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x1c:
-            {
-                const __m128i temp1 = _mm_load_si128(pbuf);
-                const __m128i temp2 = _mm_load_si128(prandex);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
+// per thread key scratch for the multi-lane miner. the buffer starts with this header, followed by
+// one key buffer per lane, each laid out like the main key: key, refresh copy, then move scratch
+struct verusclhash_lanes_descr
+{
+    uint256 seed;
+    uint32_t keySizeInBytes;
+    uint32_t nLanes;
+    unsigned char pad[24];
+};
+
+// returns the first lane key buffer, each lane is keysize << 1 bytes long. lane keys are refreshed from the main
+// key whenever its seed has changed since they were last copied. requires a current main key.
+static unsigned char *getlanekeys(int nLanes, verusclhasher &vclh, u128 *hashKey, verusclhash_descr *pdesc)
+{
+    const uint32_t keysize = pdesc->keySizeInBytes;
+    const int keyrefreshsize = vclh.keyrefreshsize();
+    const uint64_t laneSize = ((uint64_t)keysize) << 1;
+    verusclhash_lanes_descr *planes = (verusclhash_lanes_descr *)verusclhasher_lanes.get();
+    bool newLanes = false;
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp2);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp2);
+    if (!planes || planes->keySizeInBytes != keysize || planes->nLanes < nLanes)
+    {
+        verusclhasher_lanes.reset(alloc_aligned_buffer(sizeof(verusclhash_lanes_descr) + laneSize * nLanes));
+        if (!(planes = (verusclhash_lanes_descr *)verusclhasher_lanes.get()))
+        {
+            return NULL;
+        }
+        planes->keySizeInBytes = keysize;
+        planes->nLanes = nLanes;
+        newLanes = true;
+    }
 
-                const __m128i tempa3 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+    unsigned char *laneKeys = ((unsigned char *)planes) + sizeof(verusclhash_lanes_descr);
+    if (newLanes || planes->seed != pdesc->seed)
+    {
+        // the refresh area of the main key is never mutated, so it is always a clean source
+        const unsigned char *refresh = ((unsigned char *)hashKey) + keysize;
+        for (int l = 0; l < planes->nLanes; l++)
+        {
+            unsigned char *pkey = laneKeys + laneSize * l;
+            memcpy(pkey, refresh, keyrefreshsize);
+            memcpy(pkey + keyrefreshsize, ((unsigned char *)hashKey) + keyrefreshsize, keysize - keyrefreshsize);
+            memcpy(pkey + keysize, refresh, keyrefreshsize);
+            memset(pkey + keysize + keyrefreshsize, 0, keysize - keyrefreshsize);
+        }
+        planes->seed = pdesc->seed;
+    }
+    else
+    {
+        for (int l = 0; l < planes->nLanes; l++)
+        {
+            fixupkey(vclh.getpmovescratch(laneKeys + laneSize * l + keysize), pdesc);
+        }
+    }
+    return laneKeys;
+}
 
-                acc = _mm_xor_si128(tempa3, acc);
-                const __m128i temp4 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1)); 
-                acc = _mm_xor_si128(temp4,acc);  
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, tempa3);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, tempa3);
-                _mm_store_si128(prandex, tempb2);
-                break;
-            }
+// hashes LANES consecutive nonces starting at nonce against the shared intermediate state in curBuf, each lane
+// with its own key. returns the lane index of the first hash that meets target or -1, with the winning hash in
+// finalHash. keys of all lanes that did not win are restored before returning.
+template <int LANES>
+static inline __attribute__((always_inline)) int verus_v2_hash_lanes(CVerusHashV2 &vh, const unsigned char *curBuf, uint64_t nonce,
+                                                                     unsigned char *laneKeys, uint64_t laneSize, verusclhash_descr *pdesc,
+                                                                     const uint64_t *compTarget, uint256 &finalHash)
+{
+    verusclhasher &vclh = vh.vclh;
+    const uint32_t keysize = pdesc->keySizeInBytes;
+    const __m128i shuf1 = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0);
+    const __m128i shuf2 = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0);
+    const __m128i fill1 = _mm_shuffle_epi8(_mm_load_si128((u128 *)curBuf), shuf1);
+
+    alignas(32) unsigned char laneBuf[LANES][64];
+    alignas(32) uint256 laneHash[LANES];
+    unsigned char *pBuf[LANES], *pHash[LANES];
+    const u128 *pFinalKey[LANES];
+    __m128i **pMoveScratch[LANES];
+
+    u128 *laneKey[LANES];
+    const __m128i *laneInput[LANES];
+    __m128i acc[LANES];
+
+    for (int l = 0; l < LANES; l++)
+    {
+        laneKey[l] = (u128 *)(laneKeys + laneSize * l);
+        pMoveScratch[l] = vclh.getpmovescratch(((unsigned char *)laneKey[l]) + keysize);
+        pBuf[l] = laneBuf[l];
+        pHash[l] = (unsigned char *)&laneHash[l];
+        laneInput[l] = (const __m128i *)laneBuf[l];
+
+        // prepare the buffer, everything but the nonce is shared
+        memcpy(laneBuf[l], curBuf, 48);
+        *((int64_t *)(laneBuf[l] + 32)) = nonce + l;
+        _mm_store_si128((u128 *)(&laneBuf[l][32 + 16]), fill1);
+        laneBuf[l][32 + 15] = curBuf[0];
+    }
+
+    // run verusclhash on the buffers, interleaved for the current algorithm
+    if (vclh.verusinternalclhashfunction == &__verusclmulwithoutreduction64alignedrepeat_sv2_2)
+    {
+        __verusclmulwithoutreduction64alignedrepeat_sv2_2_lanes<LANES>(acc, laneKey, laneInput, vclh.keyMask, pMoveScratch);
+    }
+    else
+    {
+        for (int l = 0; l < LANES; l++)
+        {
+            acc[l] = (*vclh.verusinternalclhashfunction)(laneKey[l], laneInput[l], vclh.keyMask, pMoveScratch[l]);
         }
     }
-    return acc;
+
+    for (int l = 0; l < LANES; l++)
+    {
+        const uint64_t intermediate = precompReduction64(_mm_xor_si128(acc[l], lazyLengthHash(1024, 64)));
+
+        // fill buffer to the end with the result
+        __m128i fill2 = _mm_shuffle_epi8(_mm_loadl_epi64((u128 *)&intermediate), shuf2);
+        _mm_store_si128((u128 *)(&laneBuf[l][32 + 16]), fill2);
+        laneBuf[l][32 + 15] = *((unsigned char *)&intermediate);
+
+        pFinalKey[l] = laneKey[l] + vh.IntermediateTo128Offset(intermediate);
+    }
+
+    haraka512_keyed_lanes<LANES>(pHash, pBuf, pFinalKey);
+
+    int winner = -1;
+    for (int l = 0; l < LANES; l++)
+    {
+        const uint64_t *compResult = (uint64_t *)&laneHash[l];
+        if (winner == -1 &&
+            !(compResult[3] > compTarget[3] || (compResult[3] == compTarget[3] && compResult[2] > compTarget[2]) ||
+              (compResult[3] == compTarget[3] && compResult[2] == compTarget[2] && compResult[1] > compTarget[1]) ||
+              (compResult[3] == compTarget[3] && compResult[2] == compTarget[2] && compResult[1] == compTarget[1] && compResult[0] > compTarget[0])))
+        {
+            winner = l;
+            finalHash = laneHash[l];
+            continue;
+        }
+        // refresh the key
+        fixupkey(pMoveScratch[l], pdesc);
+    }
+    return winner;
+}
+
+// same as mine_verus_v2, but hashes LANES nonces per pass, each with its own copy of the key
+template <int LANES>
+static bool mine_verus_v2_lanes(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count)
+{
+    CVerusHashV2 &vh = vhw.GetState();
+    verusclhasher &vclh = vh.vclh;
+
+    alignas(32) uint256 curTarget = target;
+    const uint64_t *compTarget = (uint64_t *)&curTarget;
+
+    u128 *hashKey = (u128 *)verusclhasher_key.get();
+    verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
+    const uint32_t keysize = pdesc->keySizeInBytes;
+    const uint64_t laneSize = ((uint64_t)keysize) << 1;
+
+    vhw.Reset();
+    vhw << bh;
+
+    unsigned char *curBuf = vh.CurBuffer();
+
+    // generate the main key once for all lanes, skip keygen if it is the current key
+    if (pdesc->seed != *((uint256 *)curBuf))
+    {
+        vh.GenNewCLKey(curBuf);
+    }
+
+    unsigned char *laneKeys = getlanekeys(LANES, vclh, hashKey, pdesc);
+    if (!laneKeys)
+    {
+        return mine_verus_v2(bh, vhw, finalHash, target, start, count);
+    }
+
+    // loop the requested number of times in groups of LANES, then finish any remainder one at a time
+    uint64_t i = start, end = start + *count, found = end;
+    for ( ; i + LANES <= end; i += LANES)
+    {
+        int winner = verus_v2_hash_lanes<LANES>(vh, curBuf, i, laneKeys, laneSize, pdesc, compTarget, finalHash);
+        if (winner != -1)
+        {
+            found = i + winner;
+            break;
+        }
+    }
+    for ( ; found == end && i < end; i++)
+    {
+        if (verus_v2_hash_lanes<1>(vh, curBuf, i, laneKeys, laneSize, pdesc, compTarget, finalHash) != -1)
+        {
+            found = i;
+        }
+    }
+
+    if (found == end)
+    {
+        return false;
+    }
+    i = found;
+
+    std::vector<unsigned char> solution = bh.nSolution;
+    int extraSpace = (solution.size() % 32) + 15;
+    assert(solution.size() > 32);
+    *((int64_t *)&(solution.data()[solution.size() - extraSpace])) = i;
+    bh.nSolution = solution;
+    *count = (i - start) + 1;
+    return true;
+}
+
+bool mine_verus_v2x2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count)
+{
+    return mine_verus_v2_lanes<2>(bh, vhw, finalHash, target, start, count);
+}
+
+bool mine_verus_v2x4(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count)
+{
+    return mine_verus_v2_lanes<4>(bh, vhw, finalHash, target, start, count);
 }
 
 void *alloc_aligned_buffer(uint64_t bufSize)
@@ -98,6 +98,7 @@ struct thread_specific_ptr {
 
 extern thread_local thread_specific_ptr verusclhasher_key;
 extern thread_local thread_specific_ptr verusclhasher_descr;
+extern thread_local thread_specific_ptr verusclhasher_lanes;      // per lane key scratch for the multi-lane miner
 
 extern int __cpuverusoptimized;
 
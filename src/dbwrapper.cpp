@@ -4,9 +4,12 @@
 
 #include "dbwrapper.h"
 
+#include "sync.h"
 #include "util.h"
+#include "utilstrencodings.h"
 
 #include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
 
 #include <leveldb/cache.h>
 #include <leveldb/env.h>
@@ -14,14 +17,162 @@
 #include <memenv.h>
 #include <stdint.h>
 
-static leveldb::Options GetOptions(size_t nCacheSize, bool compression, int maxOpenFiles)
+#include <atomic>
+#include <set>
+
+/** LRU block cache that counts lookups, so we can report a hit rate per database */
+class CCountingLRUCache : public leveldb::Cache
+{
+private:
+    leveldb::Cache *pcache;
+    size_t capacity;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+public:
+    CCountingLRUCache(size_t nCapacity) : pcache(leveldb::NewLRUCache(nCapacity)), capacity(nCapacity), hits(0), misses(0) {}
+    ~CCountingLRUCache() { delete pcache; }
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, void (*deleter)(const leveldb::Slice& key, void* value))
+    {
+        return pcache->Insert(key, value, charge, deleter);
+    }
+
+    Handle* Lookup(const leveldb::Slice& key)
+    {
+        Handle *handle = pcache->Lookup(key);
+        if (handle)
+            hits++;
+        else
+            misses++;
+        return handle;
+    }
+
+    void Release(Handle* handle) { pcache->Release(handle); }
+    void* Value(Handle* handle) { return pcache->Value(handle); }
+    void Erase(const leveldb::Slice& key) { pcache->Erase(key); }
+    uint64_t NewId() { return pcache->NewId(); }
+
+    size_t Capacity() const { return capacity; }
+    uint64_t Hits() const { return hits; }
+    uint64_t Misses() const { return misses; }
+};
+
+// the "default" profile keeps the policy every database used before profiles existed
+static const CDBOptionsProfile dbOptionsProfiles[] = {
+    //                  name            block   bloom   cache%  write%  files   restart
+    CDBOptionsProfile("default",        4096,   10,     50,     25,     0,      16),
+    // random point reads of small values, such as the coins database
+    CDBOptionsProfile("pointread",      4096,   14,     60,     20,     0,      16),
+    // ordered range scans, such as the address, spent and timestamp indexes in the block index database
+    CDBOptionsProfile("scan",           32768,  10,     50,     25,     0,      32),
+    // bulk loading during initial sync or reindex, fewer and larger level 0 flushes
+    CDBOptionsProfile("bulkload",       16384,  10,     30,     35,     0,      16),
+    // small databases that should not hold many file handles, such as notarisations
+    CDBOptionsProfile("small",          4096,   10,     50,     25,     16,     16)
+};
+
+std::vector<std::string> GetDBOptionsProfileNames()
+{
+    std::vector<std::string> names;
+    BOOST_FOREACH(const CDBOptionsProfile &oneProfile, dbOptionsProfiles)
+        names.push_back(oneProfile.name);
+    return names;
+}
+
+bool GetDBOptionsProfile(const std::string &profileName, CDBOptionsProfile &profile)
+{
+    BOOST_FOREACH(const CDBOptionsProfile &oneProfile, dbOptionsProfiles)
+    {
+        if (oneProfile.name == profileName)
+        {
+            profile = oneProfile;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CDBOptionsProfile::SetOption(const std::string &option, const std::string &value)
+{
+    int64_t n = atoi64(value);
+    if (n < 0 || strprintf("%d", n) != value)
+        return false;
+
+    if (option == "blocksize" && n >= 1024)
+        blockSize = n;
+    else if (option == "bloombits" && n <= 64)
+        bloomBits = n;
+    else if (option == "blockcache" && n >= 1 && n <= 90)
+        blockCachePercent = n;
+    else if (option == "writebuffer" && n >= 1 && n <= 45)
+        writeBufferPercent = n;
+    else if (option == "maxopenfiles" && (n == 0 || n >= 16))
+        maxOpenFiles = n;
+    else if (option == "restartinterval" && n >= 1)
+        blockRestartInterval = n;
+    else
+        return false;
+    return true;
+}
+
+std::string CDBOptionsProfile::ToString() const
+{
+    return strprintf("%s (blocksize=%u, bloombits=%d, blockcache=%d%%, writebuffer=%d%%, maxopenfiles=%d, restartinterval=%d)",
+                     name, blockSize, bloomBits, blockCachePercent, writeBufferPercent, maxOpenFiles, blockRestartInterval);
+}
+
+CDBOptionsProfile GetConfiguredDBOptionsProfile(const std::string &dbName)
+{
+    CDBOptionsProfile profile;
+    GetDBOptionsProfile("default", profile);
+    if (dbName.empty())
+        return profile;
+
+    std::string prefix = dbName + ":";
+    BOOST_FOREACH(const std::string &arg, mapMultiArgs["-dbprofile"])
+    {
+        if (arg.compare(0, prefix.size(), prefix) == 0 &&
+            !GetDBOptionsProfile(arg.substr(prefix.size()), profile))
+        {
+            LogPrintf("Unknown database profile in -dbprofile=%s, using %s\n", arg, profile.name);
+        }
+    }
+    BOOST_FOREACH(const std::string &arg, mapMultiArgs["-dbopt"])
+    {
+        size_t eq = arg.find('=');
+        if (arg.compare(0, prefix.size(), prefix) == 0 &&
+            (eq == std::string::npos || !profile.SetOption(arg.substr(prefix.size(), eq - prefix.size()), arg.substr(eq + 1))))
+        {
+            LogPrintf("Ignoring invalid -dbopt=%s\n", arg);
+        }
+    }
+    return profile;
+}
+
+// named databases, so statistics can be reported without reaching into each owner
+static CCriticalSection cs_namedDBs;
+static std::set<const CDBWrapper *> namedDBs;
+
+std::vector<CDBWrapperStats> GetAllDBWrapperStats()
+{
+    LOCK(cs_namedDBs);
+    std::vector<CDBWrapperStats> allStats;
+    BOOST_FOREACH(const CDBWrapper *pdbw, namedDBs)
+        allStats.push_back(pdbw->GetStats());
+    return allStats;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, bool compression, int maxOpenFiles, const CDBOptionsProfile &profile)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    options.block_cache = new CCountingLRUCache(nCacheSize / 100 * profile.blockCachePercent);
+    options.write_buffer_size = nCacheSize / 100 * profile.writeBufferPercent; // up to two write buffers may be held in memory simultaneously
+    options.filter_policy = profile.bloomBits ? leveldb::NewBloomFilterPolicy(profile.bloomBits) : NULL;
+    options.block_size = profile.blockSize;
+    options.block_restart_interval = profile.blockRestartInterval;
     options.compression = compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
-    options.max_open_files = maxOpenFiles;
+    options.max_open_files = profile.maxOpenFiles ? profile.maxOpenFiles : maxOpenFiles;
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
         // on corruption in later versions.
@@ -30,14 +181,17 @@ static leveldb::Options GetOptions(size_t nCacheSize, bool compression, int maxO
     return options;
 }
 
-CDBWrapper::CDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles)
+CDBWrapper::CDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles, const std::string &dbName)
+    : name(dbName), profile(GetConfiguredDBOptionsProfile(dbName))
 {
     penv = NULL;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize, compression, maxOpenFiles);
+    options = GetOptions(nCacheSize, compression, maxOpenFiles, profile);
+    if (!name.empty())
+        LogPrintf("Using database profile %s for %s\n", profile.ToString(), name);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -54,10 +208,21 @@ CDBWrapper::CDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, b
     leveldb::Status status = leveldb::DB::Open(options, path.string(), &pdb);
     dbwrapper_private::HandleError(status);
     LogPrintf("Opened LevelDB successfully\n");
+
+    if (!name.empty())
+    {
+        LOCK(cs_namedDBs);
+        namedDBs.insert(this);
+    }
 }
 
 CDBWrapper::~CDBWrapper()
 {
+    if (!name.empty())
+    {
+        LOCK(cs_namedDBs);
+        namedDBs.erase(this);
+    }
     delete pdb;
     pdb = NULL;
     delete options.filter_policy;
@@ -75,6 +240,19 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     return true;
 }
 
+CDBWrapperStats CDBWrapper::GetStats() const
+{
+    CDBWrapperStats stats;
+    const CCountingLRUCache *pcache = static_cast<const CCountingLRUCache *>(options.block_cache);
+    stats.name = name;
+    stats.profile = profile.name;
+    stats.blockCacheSize = pcache->Capacity();
+    stats.writeBufferSize = options.write_buffer_size;
+    stats.cacheHits = pcache->Hits();
+    stats.cacheMisses = pcache->Misses();
+    return stats;
+}
+
 bool CDBWrapper::IsEmpty()
 {
     boost::scoped_ptr<CDBIterator> it(NewIterator());
@@ -16,9 +16,62 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <string>
+#include <vector>
+
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 
+/**
+ * Named set of LevelDB tuning options. A database uses the "default" profile unless
+ * -dbprofile=<database>:<profile> selects another, and individual values can be
+ * overridden with -dbopt=<database>:<option>=<value>.
+ */
+struct CDBOptionsProfile
+{
+    std::string name;
+    size_t blockSize;           //!< approximate uncompressed bytes per block
+    int bloomBits;              //!< bloom filter bits per key, 0 disables the filter
+    int blockCachePercent;      //!< share of the database cache used for the block cache
+    int writeBufferPercent;     //!< share of the database cache used for each of up to two write buffers
+    int maxOpenFiles;           //!< 0 to use the value the database was opened with
+    int blockRestartInterval;   //!< keys between restart points for key delta encoding
+
+    CDBOptionsProfile() : blockSize(4096), bloomBits(10), blockCachePercent(50), writeBufferPercent(25), maxOpenFiles(0), blockRestartInterval(16) {}
+
+    CDBOptionsProfile(const std::string &Name, size_t BlockSize, int BloomBits, int BlockCachePercent, int WriteBufferPercent, int MaxOpenFiles, int BlockRestartInterval) :
+        name(Name), blockSize(BlockSize), bloomBits(BloomBits), blockCachePercent(BlockCachePercent), writeBufferPercent(WriteBufferPercent),
+        maxOpenFiles(MaxOpenFiles), blockRestartInterval(BlockRestartInterval) {}
+
+    bool SetOption(const std::string &option, const std::string &value);
+    std::string ToString() const;
+};
+
+/** Returns the names of all built in option profiles */
+std::vector<std::string> GetDBOptionsProfileNames();
+
+/** Looks up a built in option profile by name */
+bool GetDBOptionsProfile(const std::string &profileName, CDBOptionsProfile &profile);
+
+/** Returns the profile configured for a database with -dbprofile and -dbopt */
+CDBOptionsProfile GetConfiguredDBOptionsProfile(const std::string &dbName);
+
+/** Cache and usage statistics for one database */
+struct CDBWrapperStats
+{
+    std::string name;
+    std::string profile;
+    size_t blockCacheSize;
+    size_t writeBufferSize;
+    uint64_t cacheHits;
+    uint64_t cacheMisses;
+
+    CDBWrapperStats() : blockCacheSize(0), writeBufferSize(0), cacheHits(0), cacheMisses(0) {}
+};
+
+/** Returns statistics for every open database that was given a name */
+std::vector<CDBWrapperStats> GetAllDBWrapperStats();
+
 class dbwrapper_error : public std::runtime_error
 {
 public:
@@ -168,14 +221,21 @@ private:
     //! the database itself
     leveldb::DB* pdb;
 
+    //! name used to select this database's option profile and to report its statistics
+    std::string name;
+
+    //! option profile the database was opened with
+    CDBOptionsProfile profile;
+
 public:
     /**
      * @param[in] path        Location in the filesystem where leveldb data will be stored.
      * @param[in] nCacheSize  Configures various leveldb cache settings.
      * @param[in] fMemory     If true, use leveldb's memory environment.
      * @param[in] fWipe       If true, remove all existing data.
+     * @param[in] dbName      Selects the option profile configured for this database, if any.
      */
-    CDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool compression = false, int maxOpenFiles = 64);
+    CDBWrapper(const boost::filesystem::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool compression = false, int maxOpenFiles = 64, const std::string &dbName = "");
     ~CDBWrapper();
 
     template <typename K, typename V>
@@ -261,6 +321,8 @@ public:
      * Return true if the database managed by this class contains no entries.
      */
     bool IsEmpty();
+
+    CDBWrapperStats GetStats() const;
 };
 
 #endif // BITCOIN_DBWRAPPER_H
@@ -0,0 +1,50 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_IDENTITYINDEX_H
+#define BITCOIN_IDENTITYINDEX_H
+
+#include "uint256.h"
+#include "serialize.h"
+
+#include <vector>
+
+// the current, confirmed state of an identity, keyed by identity ID, which makes the
+// latest identity on chain a single point lookup rather than an address index scan
+struct CIdentityUnspentIndexValue {
+    uint256 txhash;
+    unsigned int index;
+    int blockHeight;
+    std::vector<unsigned char> identity;    // serialized CIdentity, as found in the primary identity output
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txhash);
+        READWRITE(index);
+        READWRITE(blockHeight);
+        READWRITE(identity);
+    }
+
+    CIdentityUnspentIndexValue(const uint256 &t, unsigned int i, int h, const std::vector<unsigned char> &id) :
+        txhash(t), index(i), blockHeight(h), identity(id) {}
+
+    CIdentityUnspentIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        txhash.SetNull();
+        index = 0;
+        blockHeight = 0;
+        identity.clear();
+    }
+
+    bool IsNull() const {
+        return txhash.IsNull();
+    }
+};
+
+#endif // BITCOIN_IDENTITYINDEX_H
@@ -51,6 +51,7 @@
 #endif
 
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -366,8 +367,15 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-datadir=<dir>", _("Specify data directory"));
     strUsage += HelpMessageOpt("-exportdir=<dir>", _("Specify directory to be used when exporting data"));
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
+    strUsage += HelpMessageOpt("-dbprofile=<db>:<profile>", strprintf(_("Use a LevelDB option profile for database <db> (blockindex, chainstate or notarisations), one of: %s (default: default)"), boost::algorithm::join(GetDBOptionsProfileNames(), ", ")));
+    strUsage += HelpMessageOpt("-dbopt=<db>:<option>=<n>", _("Override one option of the profile used for database <db>, one of: blocksize, bloombits, blockcache (percent of its cache), writebuffer (percent of its cache), maxopenfiles, restartinterval"));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file") + " " + _("on startup"));
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
+    strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes, evicting the transactions with the lowest fee rate first (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
+    strUsage += HelpMessageOpt("-limitancestorcount=<n>", strprintf(_("Do not accept transactions if the number of in-mempool ancestors is <n> or more (default: %u)"), DEFAULT_ANCESTOR_LIMIT));
+    strUsage += HelpMessageOpt("-limitancestorsize=<n>", strprintf(_("Do not accept transactions whose size with all in-mempool ancestors exceeds <n> kilobytes (default: %u)"), DEFAULT_ANCESTOR_SIZE_LIMIT));
+    strUsage += HelpMessageOpt("-limitdescendantcount=<n>", strprintf(_("Do not accept transactions if any ancestor would have <n> or more in-mempool descendants (default: %u)"), DEFAULT_DESCENDANT_LIMIT));
+    strUsage += HelpMessageOpt("-limitdescendantsize=<n>", strprintf(_("Do not accept transactions if any ancestor would have more than <n> kilobytes of in-mempool descendants (default: %u)"), DEFAULT_DESCENDANT_SIZE_LIMIT));
     strUsage += HelpMessageOpt("-mempooltxinputlimit=<n>", _("[DEPRECATED FROM OVERWINTER] Set the maximum number of transparent inputs in a transaction that the mempool will accept (default: 0 = no limit applied)"));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -(int)boost::thread::hardware_concurrency(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
@@ -383,7 +391,11 @@ std::string HelpMessage(HelpMessageMode mode)
 #endif
     strUsage += HelpMessageOpt("-txindex", strprintf(_("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), 0));
     strUsage += HelpMessageOpt("-idindex", strprintf(_("Maintain a full identity index, enabling queries to select IDs with addresses, revocation or recovery IDs (default: %u)"), 0));
+    strUsage += HelpMessageOpt("-idunspentindex", strprintf(_("Maintain an index of the current state of each identity, making identity lookups a single database read (default: %u)"), 0));
+    strUsage += HelpMessageOpt("-addressbalanceindex", strprintf(_("Maintain running balance totals for each address, so getaddressbalance does not walk the address history. Requires -addressindex (default: %u)"), 0));
+    strUsage += HelpMessageOpt("-addresscurrencyindex", strprintf(_("Maintain an index of unspent outputs by address and currency, used by getaddressutxos to filter by currency. Requires -addressindex (default: %u)"), 0));
     strUsage += HelpMessageOpt("-addressindex", strprintf(_("Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)"), DEFAULT_ADDRESSINDEX));
+    strUsage += HelpMessageOpt("-utxostatsindex", strprintf(_("Maintain statistics of the unspent output set as of each block, used by gettxoutsetinfo \"muhash\". Turning it on scans the set once at startup (default: %u)"), DEFAULT_UTXOSTATSINDEX));
     strUsage += HelpMessageOpt("-timestampindex", strprintf(_("Maintain a timestamp index for block hashes, used to query blocks hashes by a range of timestamps (default: %u)"), DEFAULT_TIMESTAMPINDEX));
     strUsage += HelpMessageOpt("-spentindex", strprintf(_("Maintain a full spent index, used to query the spending txid and input index for an outpoint (default: %u)"), DEFAULT_SPENTINDEX));
     strUsage += HelpMessageOpt("-alwayssubmitnotarizations", strprintf(_("Submit notarizations to notary chain whenevever merge mining/staking and eligible (default = %u, only as needed)"), DEFAULT_SPENTINDEX));
@@ -441,6 +453,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-paytxfee=<amt>", strprintf(_("Fee (in %s/kB) to add to transactions you send (default: %s)"),
         CURRENCY_UNIT, FormatMoney(payTxFee.GetFeePerK())));
     strUsage += HelpMessageOpt("-rescan", _("Rescan the block chain for missing wallet transactions") + " " + _("on startup"));
+    strUsage += HelpMessageOpt("-rescanthreads=<n>", strprintf(_("Number of threads reading and decrypting blocks ahead of a wallet rescan, at most the number of cores (default: %u)"), DEFAULT_RESCAN_THREADS));
     strUsage += HelpMessageOpt("-salvagewallet", _("Attempt to recover private keys from a corrupt wallet.dat") + " " + _("on startup"));
     strUsage += HelpMessageOpt("-sendfreetransactions", strprintf(_("Send transactions as zero-fee transactions if possible (default: %u)"), 0));
     strUsage += HelpMessageOpt("-spendzeroconfchange", strprintf(_("Spend unconfirmed change when sending transactions (default: %u)"), 1));
@@ -545,6 +558,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-mint", strprintf(_("Mint/stake coins automatically (default: %u)"), 0));
     strUsage += HelpMessageOpt("-gen", strprintf(_("Mine/generate coins (default: %u)"), 0));
     strUsage += HelpMessageOpt("-genproclimit=<n>", strprintf(_("Set the number of threads for coin mining if enabled (-1 = all cores, default: %d)"), 0));
+    strUsage += HelpMessageOpt("-minerlanes=<n>", strprintf(_("Number of nonces each VerusHash mining thread hashes per pass on AES-NI CPUs (1, 2 or 4, default: %d)"), 1));
     strUsage += HelpMessageOpt("-equihashsolver=<name>", _("Specify the Equihash solver to be used if enabled (default: \"default\")"));
     strUsage += HelpMessageOpt("-mineraddress=<addr>", _("Send mined coins to a specific single address"));
     strUsage += HelpMessageOpt("-minetolocalwallet", strprintf(
@@ -1384,7 +1398,11 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
+        {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadHeaderHashCheck);
+            threadGroup.create_thread(&ThreadSaplingProofCheck);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1755,6 +1773,33 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
             fReindex = true;
         }
 
+        pblocktree->ReadFlag("idunspentindex", checkval);
+        fIdentityUnspentIndex = GetBoolArg("-idunspentindex", checkval);
+        if ( checkval != fIdentityUnspentIndex )
+        {
+            pblocktree->WriteFlag("idunspentindex", fIdentityUnspentIndex);
+            fprintf(stderr,"set idunspentindex, will reindex. sorry will take a while.\n");
+            fReindex = true;
+        }
+
+        pblocktree->ReadFlag("addressbalanceindex", checkval);
+        fAddressBalanceIndex = GetBoolArg("-addressbalanceindex", checkval);
+        if ( checkval != fAddressBalanceIndex )
+        {
+            pblocktree->WriteFlag("addressbalanceindex", fAddressBalanceIndex);
+            fprintf(stderr,"set addressbalanceindex, will reindex. sorry will take a while.\n");
+            fReindex = true;
+        }
+
+        pblocktree->ReadFlag("addresscurrencyindex", checkval);
+        fAddressCurrencyIndex = GetBoolArg("-addresscurrencyindex", checkval);
+        if ( checkval != fAddressCurrencyIndex )
+        {
+            pblocktree->WriteFlag("addresscurrencyindex", fAddressCurrencyIndex);
+            fprintf(stderr,"set addresscurrencyindex, will reindex. sorry will take a while.\n");
+            fReindex = true;
+        }
+
         pblocktree->ReadFlag("insightexplorer", checkval);
         fInsightExplorer = GetBoolArg("-insightexplorer", checkval);
         if ( checkval != fInsightExplorer )
@@ -1774,6 +1819,9 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
         }
     }
 
+    // the UTXO stats index needs no reindex to be turned on or off, since it is started from a scan at the current tip
+    fUTXOStatsIndex = GetBoolArg("-utxostatsindex", DEFAULT_UTXOSTATSINDEX);
+
     bool clearWitnessCaches = false;
 
     bool fLoaded = false;
@@ -1836,6 +1884,24 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
+                pblocktree->ReadFlag("idunspentindex", fIdentityUnspentIndex);
+                if (!fReindex && fIdentityUnspentIndex != GetBoolArg("-idunspentindex", fIdentityUnspentIndex) ) {
+                    strLoadError = _("You need to rebuild the database using -reindex to change -idunspentindex");
+                    break;
+                }
+
+                pblocktree->ReadFlag("addressbalanceindex", fAddressBalanceIndex);
+                if (!fReindex && fAddressBalanceIndex != GetBoolArg("-addressbalanceindex", fAddressBalanceIndex) ) {
+                    strLoadError = _("You need to rebuild the database using -reindex to change -addressbalanceindex");
+                    break;
+                }
+
+                pblocktree->ReadFlag("addresscurrencyindex", fAddressCurrencyIndex);
+                if (!fReindex && fAddressCurrencyIndex != GetBoolArg("-addresscurrencyindex", fAddressCurrencyIndex) ) {
+                    strLoadError = _("You need to rebuild the database using -reindex to change -addresscurrencyindex");
+                    break;
+                }
+
                 // Check for changed -insightexplorer state
                 pblocktree->ReadFlag("insightexplorer", fInsightExplorer);
                 if (!fReindex && fInsightExplorer != GetBoolArg("-insightexplorer", fInsightExplorer) ) {
@@ -1950,6 +2016,12 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
     LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
 
+    if (fUTXOStatsIndex) {
+        uiInterface.InitMessage(_("Starting UTXO set statistics..."));
+        if (!InitUTXOStatsIndex())
+            return InitError(_("Unable to compute UTXO set statistics"));
+    }
+
     boost::filesystem::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
     CAutoFile est_filein(fopen(est_path.string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
     // Allowed to fail as this file IS missing on first startup.
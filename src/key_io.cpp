@@ -8,6 +8,7 @@
 #include <base58.h>
 #include <bech32.h>
 #include <script/script.h>
+#include <script/decodecache.h>
 #include <utilstrencodings.h>
 
 #include <boost/variant/apply_visitor.hpp>
@@ -1657,11 +1658,16 @@ CNameReservation::CNameReservation(const CTransaction &tx, int *pOutNum)
 
 CIdentity::CIdentity(const CScript &scriptPubKey)
 {
+    if (CBlockScriptCache::GetObject(scriptPubKey, *this))
+    {
+        return;
+    }
     COptCCParams p;
     if (IsPayToCryptoCondition(scriptPubKey, p) && p.IsValid() && p.evalCode == EVAL_IDENTITY_PRIMARY && p.vData.size())
     {
         *this = CIdentity(p.vData[0]);
     }
+    CBlockScriptCache::PutObject(scriptPubKey, *this);
 }
 
 CIdentityID CIdentity::GetID(const std::string &Name, uint160 &parent)
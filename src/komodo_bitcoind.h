@@ -1543,7 +1543,7 @@ int32_t komodo_checkPOW(int32_t slowflag,CBlock *pblock,int32_t height)
 
 bool IsCoinbaseTimeLocked(const CTransaction &tx, uint32_t &outUnlockHeight);
 
-void GetImmatureCoins(std::map<uint32_t, int64_t> *pimmatureBlockAmounts, CBlock &block, uint32_t &maturity, int64_t &amount, uint32_t height)
+void GetImmatureCoins(std::map<uint32_t, int64_t> *pimmatureBlockAmounts, const CBlock &block, uint32_t &maturity, int64_t &amount, uint32_t height)
 {
     std::map<uint32_t, int64_t> _unlockBlockAmounts;
     std::map<uint32_t, int64_t> &unlockBlockAmounts = pimmatureBlockAmounts ? *pimmatureBlockAmounts : _unlockBlockAmounts;
@@ -1585,57 +1585,6 @@ void GetImmatureCoins(std::map<uint32_t, int64_t> *pimmatureBlockAmounts, CBlock
     }
 }
 
-bool GetNewCoins(int64_t &newCoins, int64_t *pzsupplydelta, std::map<uint32_t, int64_t> *pimmatureBlockAmounts, CBlock &block, uint32_t &maturity, int64_t &amount, uint32_t height)
-{
-    int64_t _zfunds;
-    int64_t &zfunds = pzsupplydelta ? *pzsupplydelta : _zfunds;
-    std::map<uint32_t, int64_t> _unlockBlockAmounts;
-    std::map<uint32_t, int64_t> &unlockBlockAmounts = pimmatureBlockAmounts ? *pimmatureBlockAmounts : _unlockBlockAmounts;
-
-    for (auto &tx : block.vtx)
-    {
-        if (tx.IsCoinBase())
-        {
-            for (auto &out : tx.vout)
-            {
-                newCoins += out.nValue;
-            }
-            GetImmatureCoins(&unlockBlockAmounts, block, maturity, amount, height);
-        }
-        else
-        {
-            int64_t vinSum = 0, voutSum = 0;
-            CTransaction vinTx;
-            uint256 blockHash;
-
-            for (auto &in : tx.vin)
-            {
-                if ( !GetTransaction(in.prevout.hash, vinTx, blockHash, false) || in.prevout.n >= vinTx.vout.size() )
-                {
-                    fprintf(stderr,"ERROR: %s/v%d cant find\n", in.prevout.hash.ToString().c_str(), in.prevout.n);
-                    return false;
-                }
-                vinSum += vinTx.vout[in.prevout.n].nValue;
-            }
-            for (auto &out : tx.vout)
-            {
-                if ( !out.scriptPubKey.IsOpReturn() )
-                {
-                    voutSum += out.nValue;
-                }
-            }
-            // this should be a negative number due to fees, which will mature when the coinbase does
-            // all normal blocks should have negative coin emission due to maturity only
-            // resolving the pmatureBlockAmounts map is required for an accurate mature and immature supply
-            newCoins += voutSum - vinSum;
-        }
-    }
-
-    zfunds += (chainActive[height]->nSproutValue ? chainActive[height]->nSproutValue.get() : 0) + chainActive[height]->nSaplingValue;
-
-    return true;
-}
-
 int64_t komodo_newcoins(int64_t *zfundsp,int32_t nHeight,CBlock *pblock)
 {
     CTxDestination address; int32_t i,j,m,n,vout; uint8_t *script; uint256 txid,hashBlock; int64_t zfunds=0,vinsum=0,voutsum=0;
@@ -1713,62 +1662,137 @@ int64_t komodo_coinsupply(int64_t *zfundsp,int32_t height)
     return(supply);
 }
 
+// compute the coin supply index entry of a block from the entry of its parent and the values its inputs spent, as recorded
+// in its undo data. ConnectBlock and the backfill in GetCoinSupply both come here, so entries agree however they were written.
+// normally maturing coinbase amounts are released by looking back COINBASE_MATURITY blocks, and only coinbases that are
+// time locked past that are carried forward in the entry, so entries stay small. fails if the parent has no entry.
+bool GetBlockCoinSupply(const CBlockIndex *pindex, const CBlock &block, const CBlockUndo &blockundo, CCoinSupplyIndexValue &value)
+{
+    uint32_t height = pindex->GetHeight();
+    if (block.vtx.size() != blockundo.vtxundo.size() + 1)
+    {
+        return false;
+    }
+
+    CCoinSupplyIndexValue prevValue;
+    if (height > 1 && !GetCoinSupplyIndex(pindex->pprev, prevValue))
+    {
+        return false;
+    }
+
+    int64_t maturing = 0;
+    if (height > COINBASE_MATURITY)
+    {
+        CCoinSupplyIndexValue maturingValue;
+        if (!GetCoinSupplyIndex(pindex->GetAncestor(height - COINBASE_MATURITY), maturingValue))
+        {
+            return false;
+        }
+        if (maturingValue.maturity == height)
+        {
+            maturing = maturingValue.immature;
+        }
+    }
+
+    // all coinbase outputs are new coins. other transactions change the supply by their spendable outputs less the
+    // outputs they spend, which is negative by their fees, since those are claimed by the coinbase
+    int64_t newCoins = 0;
+    for (int i = 0; i < block.vtx.size(); i++)
+    {
+        const CTransaction &tx = block.vtx[i];
+        for (auto &out : tx.vout)
+        {
+            if (tx.IsCoinBase() || !out.scriptPubKey.IsOpReturn())
+            {
+                newCoins += out.nValue;
+            }
+        }
+        if (i > 0)
+        {
+            for (auto &prevout : blockundo.vtxundo[i - 1].vprevout)
+            {
+                newCoins -= prevout.txout.nValue;
+            }
+        }
+    }
+
+    std::map<uint32_t, int64_t> unlockBlockAmounts;
+    int64_t amount;
+    value.SetNull();
+    GetImmatureCoins(&unlockBlockAmounts, block, value.maturity, amount, height);
+    // instant spend outputs are released at height 1, so are never immature
+    value.immature = value.maturity > height ? unlockBlockAmounts[value.maturity] : 0;
+    value.newCoins = newCoins;
+
+    value.chainSupply = prevValue.chainSupply + newCoins;
+    value.chainZFunds = prevValue.chainZFunds + (pindex->nSproutValue ? pindex->nSproutValue.get() : 0) + pindex->nSaplingValue;
+
+    value.timeLocked = prevValue.timeLocked;
+    auto lastIt = value.timeLocked.upper_bound(height);
+    for (auto it = value.timeLocked.begin(); it != lastIt; it++)
+    {
+        maturing += it->second;
+    }
+    value.timeLocked.erase(value.timeLocked.begin(), lastIt);
+
+    value.chainImmature = prevValue.chainImmature - maturing + value.immature;
+    if (value.immature && value.maturity > height + COINBASE_MATURITY)
+    {
+        value.timeLocked[value.maturity] += value.immature;
+    }
+    return true;
+}
+
 bool GetCoinSupply(int64_t &transparentSupply, int64_t *pzsupply, int64_t *pimmaturesupply, uint32_t height)
 {
     int64_t _immature = 0, _zsupply = 0;
     int64_t &immature = pimmaturesupply ? *pimmaturesupply : _immature;
     int64_t &zfunds = pzsupply ? *pzsupply : _zsupply;
 
-    // keep a running map of immature coin amounts and block maturity as we move forward on the block chain
-    std::map<uint32_t, int64_t> immatureBlockAmounts;
-
     if (height > chainActive.Height())
     {
         height = chainActive.Height();
     }
 
-    for (int curHeight = 1; curHeight <= height; curHeight++)
+    CCoinSupplyIndexValue supplyValue;
+
+    // blocks connected since the index was added carry their supply totals, so this is a single lookup unless
+    // the chain was synced before that, in which case the entries are filled in once from height 1 and reused
+    bool haveEntry;
     {
-        CBlockIndex *pIndex;
-        CBlock block;
         LOCK(cs_main);
-        if ( (pIndex = komodo_chainactive(curHeight)) != 0 )
+        haveEntry = height == 0 || GetCoinSupplyIndex(komodo_chainactive(height), supplyValue);
+    }
+
+    if (!haveEntry)
+    {
+        for (int curHeight = 1; curHeight <= height; curHeight++)
         {
-            if ( pIndex->newcoins == 0 && pIndex->zfunds == 0 )
+            CBlockIndex *pIndex;
+            CBlock block;
+            CBlockUndo blockundo;
+            LOCK(cs_main);
+            if ( (pIndex = komodo_chainactive(curHeight)) == 0 )
             {
-                if ( !komodo_blockload(block, pIndex) == 0 || !GetNewCoins(pIndex->newcoins, &pIndex->zfunds, &immatureBlockAmounts, block, pIndex->maturity, pIndex->immature, curHeight) )
-                {
-                    fprintf(stderr,"error loading block.%d\n", pIndex->GetHeight());
-                    return false;
-                }
+                return false;
             }
-            else
+            if ( !GetCoinSupplyIndex(pIndex, supplyValue) )
             {
-                if (pIndex->maturity)
+                if ( !komodo_blockload(block, pIndex) == 0 ||
+                     !ReadBlockUndoFromDisk(blockundo, pIndex) ||
+                     !GetBlockCoinSupply(pIndex, block, blockundo, supplyValue) ||
+                     !WriteCoinSupplyIndex(pIndex, supplyValue) )
                 {
-                    if (immatureBlockAmounts.count(pIndex->maturity))
-                    {
-                        immatureBlockAmounts[pIndex->maturity] += pIndex->immature;
-                    }
-                    else
-                    {
-                        immatureBlockAmounts[pIndex->maturity] = pIndex->immature;
-                    }
+                    fprintf(stderr,"error loading block.%d\n", pIndex->GetHeight());
+                    return false;
                 }
             }
-
-            transparentSupply += pIndex->newcoins;
-            zfunds += pIndex->zfunds;
         }
     }
 
-    // remove coins that matured this block from the map to prevent double counting
-    auto lastIt = immatureBlockAmounts.upper_bound(height);
-    immatureBlockAmounts.erase(immatureBlockAmounts.begin(), lastIt);
-    for (auto &lockedAmount : immatureBlockAmounts)
-    {
-        immature += lockedAmount.second;
-    }
+    transparentSupply += supplyValue.chainSupply;
+    zfunds += supplyValue.chainZFunds;
+    immature += supplyValue.chainImmature;
 
     return true;
 }
@@ -197,6 +197,34 @@ public:
         }
     }
 
+    void Clear()
+    {
+        if (m_threadSafe)
+        {
+            LOCK(m_cacheLock);
+            m_lookUpMap.clear();
+            m_lruList.clear();
+        }
+        else
+        {
+            m_lookUpMap.clear();
+            m_lruList.clear();
+        }
+    }
+
+    int Size()
+    {
+        if (m_threadSafe)
+        {
+            LOCK(m_cacheLock);
+            return m_lruList.size();
+        }
+        else
+        {
+            return m_lruList.size();
+        }
+    }
+
 private:
     void ensureCompaction()
     {
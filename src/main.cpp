@@ -20,6 +20,7 @@
 #include "clientversion.h"
 #include "consensus/upgrades.h"
 #include "consensus/validation.h"
+#include "crypto/sha256.h"
 #include "deprecation.h"
 #include "init.h"
 #include "merkleblock.h"
@@ -31,6 +32,8 @@
 #include "pbaas/notarization.h"
 #include "pbaas/identity.h"
 #include "pow.h"
+#include "random.h"
+#include "script/decodecache.h"
 #include "script/interpreter.h"
 #include "txdb.h"
 #include "txmempool.h"
@@ -56,6 +59,7 @@
 #include <boost/math/distributions/poisson.hpp>
 #include <boost/thread.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/unordered_set.hpp>
 
 using namespace std;
 
@@ -88,6 +92,10 @@ bool fImporting = false;
 bool fReindex = false;
 bool fTxIndex = true;
 bool fIdIndex = false;
+bool fIdentityUnspentIndex = false;
+bool fAddressBalanceIndex = false;
+bool fAddressCurrencyIndex = false;
+bool fUTXOStatsIndex = false;
 bool fInsightExplorer = false;       // this ensures that the primary address and spent indexes are active, enabling advanced CCs
 bool fAddressIndex = true;
 bool fSpentIndex = true;
@@ -365,16 +373,15 @@ namespace {
         mapNodeState.erase(nodeid);
     }
 
-    void LimitMempoolSize(CTxMemPool& pool, size_t limit, unsigned long age)
+    void LimitMempoolSize(CTxMemPool& pool, size_t limit)
     {
-        /*    int expired = pool.Expire(GetTime() - age);
-         if (expired != 0)
-         LogPrint("mempool", "Expired %i transactions from the memory pool\n", expired);
-
-         std::vector<uint256> vNoSpendsRemaining;
-         pool.TrimToSize(limit, &vNoSpendsRemaining);
-         BOOST_FOREACH(const uint256& removed, vNoSpendsRemaining)
-         pcoinsTip->Uncache(removed);*/
+        // transactions expire by block height, in removeExpired, so only the size limit applies here
+        std::vector<uint256> vNoSpendsRemaining;
+        size_t nEvicted = pool.TrimToSize(limit, &vNoSpendsRemaining);
+        if (nEvicted != 0)
+            LogPrint("mempool", "Evicted %u transactions to keep the memory pool under %u bytes\n", nEvicted, limit);
+        BOOST_FOREACH(const uint256& removed, vNoSpendsRemaining)
+            pcoinsTip->Uncache(removed);
     }
 
     // Requires cs_main.
@@ -1171,6 +1178,165 @@ bool ContextualCheckCoinbaseTransaction(const CTransaction &tx, uint32_t nHeight
     return valid;
 }
 
+class CSaplingProofCacheHasher
+{
+public:
+    size_t operator()(const uint256& key) const {
+        return key.GetCheapHash();
+    }
+};
+
+/**
+ * Valid Sapling proof cache, to avoid verifying the spend and output proofs of a transaction
+ * twice (once when accepted into the memory pool, and again when its block is connected), and
+ * so that ConnectBlock can verify them on the check threads ahead of its sequential checks.
+ */
+class CSaplingProofCache
+{
+private:
+    //! Entries are SHA256(nonce || txid || shielded signature hash):
+    uint256 nonce;
+    typedef boost::unordered_set<uint256, CSaplingProofCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CSaplingProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void ComputeEntry(uint256& entry, const uint256 &txid, const uint256 &dataToBeSigned)
+    {
+        CSHA256().Write(nonce.begin(), 32).Write(txid.begin(), 32).Write(dataToBeSigned.begin(), 32).Finalize(entry.begin());
+    }
+
+    bool Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.count(entry);
+    }
+
+    void Set(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        while (setValid.size() >= MAX_SAPLING_PROOF_CACHE_ENTRIES)
+        {
+            map_type::size_type s = GetRand(setValid.bucket_count());
+            map_type::local_iterator it = setValid.begin(s);
+            if (it != setValid.end(s)) {
+                setValid.erase(*it);
+            }
+        }
+        setValid.insert(entry);
+    }
+};
+
+static CSaplingProofCache saplingProofCache;
+
+/**
+ * Compute the signature hash that the joinsplit signature, the Sapling spend authorization signatures
+ * and the binding signature of a shielded transaction commit to. Returns false if it cannot be computed.
+ */
+static bool GetShieldedDataToBeSigned(const CTransaction &tx, const CChainParams& chainparams, int nHeight, uint256 &dataToBeSigned)
+{
+    bool isVerusVault = CVerusSolutionVector::GetVersionByHeight(nHeight) >= CActivationHeight::ACTIVATE_VERUSVAULT;
+    auto consensusBranchId = CurrentEpochBranchId(nHeight, chainparams.GetConsensus());
+    // Empty output script.
+    CScript scriptCode;
+    bool sigHashSingle = false;
+
+    if (isVerusVault && tx.vJoinSplit.empty() && tx.vShieldedSpend.empty() && !tx.vShieldedOutput.empty() && tx.vin.size() > 0)
+    {
+        // if vin[0] is a smart signature for SIGHASH_SINGLE | SIGHASH_ANYONECANPAY, and the tx has no shielded spends,
+        // but does have shielded outputs, the transaction binding signature is only bound to the transparent input,
+        // all z-outputs, and no z-inputs. if there are shielded inputs, we do not afford the transaction this exception
+        CSmartTransactionSignatures smartSigs;
+        std::vector<unsigned char> ffVec = GetFulfillmentVector(tx.vin[0].scriptSig);
+        if (ffVec.size() && (smartSigs = CSmartTransactionSignatures(std::vector<unsigned char>(ffVec.begin(), ffVec.end()))).IsValid())
+        {
+            if (smartSigs.sigHashType == (SIGHASH_SINGLE | SIGHASH_ANYONECANPAY))
+            {
+                sigHashSingle = true;
+            }
+        }
+    }
+    try {
+        if (sigHashSingle == true)
+        {
+            dataToBeSigned = SignatureHash(scriptCode, tx, 0, SIGHASH_SINGLE | SIGHASH_ANYONECANPAY, 0, consensusBranchId);
+        }
+        else
+        {
+            dataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, consensusBranchId);
+        }
+    } catch (std::logic_error ex) {
+        return false;
+    }
+    return true;
+}
+
+bool CSaplingProofCheck::operator()()
+{
+    const CTransaction &tx = *ptx;
+    auto ctx = librustzcash_sapling_verification_ctx_init();
+
+    for (const SpendDescription &spend : tx.vShieldedSpend) {
+        if (!librustzcash_sapling_check_spend(
+            ctx,
+            spend.cv.begin(),
+            spend.anchor.begin(),
+            spend.nullifier.begin(),
+            spend.rk.begin(),
+            spend.zkproof.begin(),
+            spend.spendAuthSig.begin(),
+            dataToBeSigned.begin()
+        ))
+        {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            strError = "Sapling spend description invalid";
+            strRejectReason = "bad-txns-sapling-spend-description-invalid";
+            return false;
+        }
+    }
+
+    for (const OutputDescription &output : tx.vShieldedOutput) {
+        if (!librustzcash_sapling_check_output(
+            ctx,
+            output.cv.begin(),
+            output.cm.begin(),
+            output.ephemeralKey.begin(),
+            output.zkproof.begin()
+        ))
+        {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            strError = "Sapling output description invalid";
+            strRejectReason = "bad-txns-sapling-output-description-invalid";
+            return false;
+        }
+    }
+
+    if (!librustzcash_sapling_final_check(
+        ctx,
+        tx.valueBalance,
+        tx.bindingSig.begin(),
+        dataToBeSigned.begin()
+    ))
+    {
+        librustzcash_sapling_verification_ctx_free(ctx);
+        strError = "Sapling binding signature invalid";
+        strRejectReason = "bad-txns-sapling-binding-signature-invalid";
+        return false;
+    }
+
+    librustzcash_sapling_verification_ctx_free(ctx);
+
+    uint256 entry;
+    saplingProofCache.ComputeEntry(entry, tx.GetHash(), dataToBeSigned);
+    saplingProofCache.Set(entry);
+    return true;
+}
+
 /**
  * Check a transaction contextually against a set of consensus rules valid at a given block height.
  *
@@ -1193,7 +1359,6 @@ bool ContextualCheckTransaction(
     bool isSprout = !overwinterActive;
 
     uint32_t verusVersion = CVerusSolutionVector::GetVersionByHeight(nHeight);
-    bool isVerusVault = verusVersion >= CActivationHeight::ACTIVATE_VERUSVAULT;
     bool isPBaaS = verusVersion >= CActivationHeight::ACTIVATE_PBAAS;
 
     // If Sprout rules apply, reject transactions which are intended for Overwinter and beyond
@@ -1291,36 +1456,8 @@ bool ContextualCheckTransaction(
          !tx.vShieldedSpend.empty() ||
          !tx.vShieldedOutput.empty()))
     {
-        auto consensusBranchId = CurrentEpochBranchId(nHeight, chainparams.GetConsensus());
-        // Empty output script.
-        CScript scriptCode;
-        bool sigHashSingle = false;
-
-        if (isVerusVault && tx.vJoinSplit.empty() && tx.vShieldedSpend.empty() && !tx.vShieldedOutput.empty() && tx.vin.size() > 0)
+        if (!GetShieldedDataToBeSigned(tx, chainparams, nHeight, dataToBeSigned))
         {
-            // if vin[0] is a smart signature for SIGHASH_SINGLE | SIGHASH_ANYONECANPAY, and the tx has no shielded spends,
-            // but does have shielded outputs, the transaction binding signature is only bound to the transparent input,
-            // all z-outputs, and no z-inputs. if there are shielded inputs, we do not afford the transaction this exception
-            CSmartTransactionSignatures smartSigs;
-            std::vector<unsigned char> ffVec = GetFulfillmentVector(tx.vin[0].scriptSig);
-            if (ffVec.size() && (smartSigs = CSmartTransactionSignatures(std::vector<unsigned char>(ffVec.begin(), ffVec.end()))).IsValid())
-            {
-                if (smartSigs.sigHashType == (SIGHASH_SINGLE | SIGHASH_ANYONECANPAY))
-                {
-                    sigHashSingle = true;
-                }
-            }
-        }
-        try {
-            if (sigHashSingle == true)
-            {
-                dataToBeSigned = SignatureHash(scriptCode, tx, 0, SIGHASH_SINGLE | SIGHASH_ANYONECANPAY, 0, consensusBranchId);
-            }
-            else
-            {
-                dataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, consensusBranchId);
-            }
-        } catch (std::logic_error ex) {
             return state.DoS(100, error("CheckTransaction(): error computing signature hash"),
                              REJECT_INVALID, "error-computing-signature-hash");
         }
@@ -1360,57 +1497,22 @@ bool ContextualCheckTransaction(
     if (!tx.vShieldedSpend.empty() ||
         !tx.vShieldedOutput.empty())
     {
-        auto ctx = librustzcash_sapling_verification_ctx_init();
-
-        for (const SpendDescription &spend : tx.vShieldedSpend) {
-            if (!librustzcash_sapling_check_spend(
-                ctx,
-                spend.cv.begin(),
-                spend.anchor.begin(),
-                spend.nullifier.begin(),
-                spend.rk.begin(),
-                spend.zkproof.begin(),
-                spend.spendAuthSig.begin(),
-                dataToBeSigned.begin()
-            ))
-            {
-                librustzcash_sapling_verification_ctx_free(ctx);
-                return state.DoS(100, error("ContextualCheckTransaction(): Sapling spend description invalid"),
-                                      REJECT_INVALID, "bad-txns-sapling-spend-description-invalid");
-            }
-        }
-
-        for (const OutputDescription &output : tx.vShieldedOutput) {
-            if (!librustzcash_sapling_check_output(
-                ctx,
-                output.cv.begin(),
-                output.cm.begin(),
-                output.ephemeralKey.begin(),
-                output.zkproof.begin()
-            ))
+        uint256 entry;
+        saplingProofCache.ComputeEntry(entry, tx.GetHash(), dataToBeSigned);
+        if (!saplingProofCache.Get(entry))
+        {
+            CSaplingProofCheck check(tx, dataToBeSigned);
+            if (!check())
             {
-                librustzcash_sapling_verification_ctx_free(ctx);
-                return state.DoS(100, error("ContextualCheckTransaction(): Sapling output description invalid"),
-                                      REJECT_INVALID, "bad-txns-sapling-output-description-invalid");
+                return state.DoS(100, error("ContextualCheckTransaction(): %s", check.GetError()),
+                                      REJECT_INVALID, check.GetRejectReason());
             }
         }
-
-        if (!librustzcash_sapling_final_check(
-            ctx,
-            tx.valueBalance,
-            tx.bindingSig.begin(),
-            dataToBeSigned.begin()
-        ))
-        {
-            librustzcash_sapling_verification_ctx_free(ctx);
-            return state.DoS(100, error("ContextualCheckTransaction(): Sapling binding signature invalid"),
-                                  REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
-        }
-
-        librustzcash_sapling_verification_ctx_free(ctx);
     }
 
     // precheck all crypto conditions
+    // these checks stay on the calling thread, even for blocks, since the PBaaS and identity prechecks read chainActive
+    // and take cs_main and mempool.cs themselves, which a check queue worker cannot do while ConnectBlock holds cs_main
     for (int i = 0; i < tx.vout.size(); i++)
     {
         COptCCParams p;
@@ -1786,6 +1888,24 @@ CAmount GetMinRelayFee(const CTransaction& tx, unsigned int nBytes, bool fAllowF
     return nMinFee;
 }
 
+bool CheckMemPoolPackageLimits(const CTxMemPool &pool, const CTxMemPoolEntry &entry, const CReserveTransactionDescriptor &txDesc, std::string &errString)
+{
+    // exports aggregate many unconfirmed transfers and chain on the last export, imports chain on the last import,
+    // and notarizations on the last notarization, so these are not limited, as they would otherwise stall cross-chain
+    // operation behind a long unconfirmed package
+    if (txDesc.IsValid() && (txDesc.IsImport() || txDesc.IsExport() || txDesc.IsNotaryPrioritized()))
+    {
+        return true;
+    }
+
+    CTxMemPool::setEntries setAncestors;
+    size_t nLimitAncestors = GetArg("-limitancestorcount", DEFAULT_ANCESTOR_LIMIT);
+    size_t nLimitAncestorSize = GetArg("-limitancestorsize", DEFAULT_ANCESTOR_SIZE_LIMIT) * 1000;
+    size_t nLimitDescendants = GetArg("-limitdescendantcount", DEFAULT_DESCENDANT_LIMIT);
+    size_t nLimitDescendantSize = GetArg("-limitdescendantsize", DEFAULT_DESCENDANT_SIZE_LIMIT) * 1000;
+    return pool.CalculateMemPoolAncestors(entry, setAncestors, nLimitAncestors, nLimitAncestorSize, nLimitDescendants, nLimitDescendantSize, errString);
+}
+
 bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransaction &tx, bool fLimitFree,
                            bool* pfMissingInputs, bool fRejectAbsurdFee, int dosLevel)
 {
@@ -2084,6 +2204,12 @@ bool AcceptToMemoryPoolInt(CTxMemPool& pool, CValidationState &state, const CTra
         auto consensusBranchId = CurrentEpochBranchId(chainActive.Height() + 1, Params().GetConsensus());
 
         CTxMemPoolEntry entry(tx, nFees, GetTime(), dPriority, chainActive.Height(), mempool.HasNoInputsOf(tx), fSpendsCoinbase, consensusBranchId, txDesc.IsValid() && txDesc.IsReserve() != 0);
+        if (txDesc.IsValid() && chainActive.LastTip())
+        {
+            // keep the descriptor with the entry, so the miner and ConnectBlock can reuse it
+            // when the transaction is mined on top of the block it was computed against
+            entry.SetReserveDescriptor(txDesc, nextBlockHeight, chainActive.LastTip()->GetBlockHash());
+        }
 
         unsigned int nSize = entry.GetTxSize();
 
@@ -2171,6 +2297,14 @@ bool AcceptToMemoryPoolInt(CTxMemPool& pool, CValidationState &state, const CTra
             return state.Error("AcceptToMemoryPool: " + errmsg);
         }
 
+        // Keep the in-mempool packages this transaction joins small, since adding or removing a
+        // transaction updates every ancestor and descendant while the mempool is locked
+        std::string errString;
+        if (!CheckMemPoolPackageLimits(pool, entry, txDesc, errString))
+        {
+            return state.DoS(0, error("AcceptToMemoryPool: too long mempool chain %s, %s", hash.ToString(), errString), REJECT_NONSTANDARD, "too-long-mempool-chain");
+        }
+
         // Check against previous transactions
         // This is done last to help prevent CPU exhaustion denial-of-service attacks.
         PrecomputedTransactionData txdata(tx);
@@ -2239,6 +2373,11 @@ bool AcceptToMemoryPoolInt(CTxMemPool& pool, CValidationState &state, const CTra
                 pool.addSpentIndex(entry, view);
             }
         }
+
+        // trim the pool to its size limit, which may evict this transaction if its fee rate is too low
+        LimitMempoolSize(pool, GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000);
+        if (!pool.exists(hash))
+            return state.DoS(0, false, REJECT_INSUFFICIENTFEE, "mempool full");
     }
 
     return true;
@@ -2272,26 +2411,85 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
     return true;
 }
 
+bool GetIdentityUnspent(const uint160 &identityID, CIdentityUnspentIndexValue &value)
+{
+    if (!fIdentityUnspentIndex)
+        return false;
+
+    return pblocktree->ReadIdentityUnspentIndex(identityID, value);
+}
+
+bool GetCoinSupplyIndex(const CBlockIndex *pindex, CCoinSupplyIndexValue &value)
+{
+    if (!pindex)
+        return false;
+
+    return pblocktree->ReadCoinSupplyIndex(pindex->GetBlockHash(), value);
+}
+
+bool WriteCoinSupplyIndex(const CBlockIndex *pindex, const CCoinSupplyIndexValue &value)
+{
+    return pblocktree->WriteCoinSupplyIndex(pindex->GetBlockHash(), value);
+}
+
+bool GetUTXOStatsIndex(const CBlockIndex *pindex, CUTXOStatsIndexValue &value)
+{
+    if (!pindex)
+        return false;
+
+    return pblocktree->ReadUTXOStatsIndex(pindex->GetBlockHash(), value);
+}
+
+bool WriteUTXOStatsIndex(const CBlockIndex *pindex, const CUTXOStatsIndexValue &value)
+{
+    return pblocktree->WriteUTXOStatsIndex(pindex->GetBlockHash(), value);
+}
+
+bool GetAddressBalance(const uint160& addressHash, int type, CAddressBalanceValue &value)
+{
+    if (!fAddressBalanceIndex)
+        return error("address balance index not enabled");
+
+    value.SetNull();
+    // an address that has never been seen has no entry, which is a zero balance
+    pblocktree->ReadAddressBalanceIndex(addressHash, type, value);
+    return true;
+}
+
+bool GetAddressUnspentCurrency(const uint160& addressHash, int type, const uint160& currencyID,
+                               std::vector<CAddressUnspentCurrencyDbEntry>& unspentOutputs)
+{
+    if (!fAddressCurrencyIndex)
+        return error("address currency index not enabled");
+
+    if (!pblocktree->ReadAddressUnspentCurrencyIndex(addressHash, type, currencyID, unspentOutputs))
+        return error("unable to get txids for address and currency");
+
+    return true;
+}
+
 bool GetAddressIndex(const uint160& addressHash, int type,
                      std::vector<CAddressIndexDbEntry>& addressIndex,
-                     int start, int end)
+                     int start, int end,
+                     CAddressIndexPage<CAddressIndexKey> *pPage)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
+    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end, pPage))
         return error("unable to get txids for address");
 
     return true;
 }
 
 bool GetAddressUnspent(const uint160& addressHash, int type,
-                       std::vector<CAddressUnspentDbEntry>& unspentOutputs)
+                       std::vector<CAddressUnspentDbEntry>& unspentOutputs,
+                       CAddressIndexPage<CAddressUnspentKey> *pPage)
 {
     if (!fAddressIndex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
+    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, pPage))
         return error("unable to get txids for address");
 
     return true;
@@ -2855,7 +3053,12 @@ namespace Consensus {
 
         bool isPBaaS = CConstVerusSolutionVector::GetVersionByHeight(nSpendHeight) >= CActivationHeight::ACTIVATE_PBAAS;
 
-        CReserveTransactionDescriptor rtxd(tx, inputs, nSpendHeight);
+        CReserveTransactionDescriptor rtxd;
+        if (!mempool.GetReserveDescriptor(tx.GetHash(), rtxd, nSpendHeight, inputs.GetBestBlock()))
+        {
+            rtxd = CReserveTransactionDescriptor(tx, inputs, nSpendHeight);
+        }
+        rtxd.ptx = &tx;
         if (isPBaaS && !rtxd.IsValid())
         {
             return state.DoS(10, error("Invalid reserve transaction"), REJECT_INVALID, "bad-txns-invalid-reservetx");
@@ -3183,6 +3386,160 @@ namespace {
 
 } // anon namespace
 
+bool ReadBlockUndoFromDisk(CBlockUndo &blockundo, const CBlockIndex *pindex)
+{
+    if (!pindex->pprev || !(pindex->nStatus & BLOCK_HAVE_UNDO))
+        return error("%s: no undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+
+    return UndoReadFromDisk(blockundo, pindex->GetUndoPos(), pindex->pprev->GetBlockHash());
+}
+
+// add the outputs a block creates to UTXO set statistics and remove the outputs it spends, which are in its undo
+// data, or with fConnect false, take the block back out of the statistics
+void UpdateUTXOStats(const CBlock &block, const CBlockUndo &blockundo, CUTXOStatsIndexValue &stats, bool fConnect)
+{
+    for (int i = 0; i < block.vtx.size(); i++)
+    {
+        const CTransaction &tx = block.vtx[i];
+        if (i > 0)
+        {
+            // UpdateCoins stops, without adding the outputs, at an input it cannot find, so a transaction with fewer
+            // spent outputs in its undo data than inputs has none of its outputs in the coins database
+            const std::vector<CTxInUndo> &vprevout = blockundo.vtxundo[i - 1].vprevout;
+            for (int j = 0; j < vprevout.size(); j++)
+            {
+                if (fConnect)
+                {
+                    stats.RemoveOutput(tx.vin[j].prevout, vprevout[j].txout);
+                }
+                else
+                {
+                    stats.AddOutput(tx.vin[j].prevout, vprevout[j].txout);
+                }
+            }
+            if (vprevout.size() < tx.vin.size())
+            {
+                continue;
+            }
+        }
+
+        uint256 txid = tx.GetHash();
+        for (int j = 0; j < tx.vout.size(); j++)
+        {
+            // unspendable outputs are never added to the coins database
+            if (tx.vout[j].scriptPubKey.IsUnspendable())
+            {
+                continue;
+            }
+            if (fConnect)
+            {
+                stats.AddOutput(COutPoint(txid, j), tx.vout[j]);
+            }
+            else
+            {
+                stats.RemoveOutput(COutPoint(txid, j), tx.vout[j]);
+            }
+        }
+    }
+}
+
+// the UTXO set statistics as of a block of the active chain. if the block has no index entry, the statistics of the
+// nearest indexed block above it are rolled back to it with the undo data of the blocks between, and an entry is
+// written for each block on the way, so the next request for any of those heights is a lookup. only the blocks to
+// roll back are found under cs_main. the rollback reads from disk and is done without it
+bool GetUTXOStats(const CBlockIndex *pindex, CUTXOStatsIndexValue &value, std::string &strError)
+{
+    struct CRollbackBlock {
+        const CBlockIndex *pindex;
+        CDiskBlockPos blockPos;
+        CDiskBlockPos undoPos;
+        uint256 prevHash;
+    };
+    std::vector<CRollbackBlock> rollback;
+
+    {
+        LOCK(cs_main);
+        if (!chainActive.Contains(pindex))
+        {
+            strError = "Block is not in the active chain";
+            return false;
+        }
+
+        if (GetUTXOStatsIndex(pindex, value))
+            return true;
+
+        const CBlockIndex *pindexIndexed = chainActive.Next(pindex);
+        while (pindexIndexed && !GetUTXOStatsIndex(pindexIndexed, value))
+        {
+            pindexIndexed = chainActive.Next(pindexIndexed);
+        }
+        if (!pindexIndexed)
+        {
+            strError = "No UTXO set statistics are indexed at or above this height";
+            return false;
+        }
+
+        for (; pindexIndexed != pindex; pindexIndexed = pindexIndexed->pprev)
+        {
+            if (!(pindexIndexed->nStatus & BLOCK_HAVE_DATA) || !(pindexIndexed->nStatus & BLOCK_HAVE_UNDO))
+            {
+                strError = strprintf("Block or undo data not available for block %s at height %d", pindexIndexed->GetBlockHash().GetHex(), pindexIndexed->GetHeight());
+                return false;
+            }
+            rollback.push_back({pindexIndexed, pindexIndexed->GetBlockPos(), pindexIndexed->GetUndoPos(), pindexIndexed->pprev->GetBlockHash()});
+        }
+    }
+
+    // entries are keyed by block hash and hold the statistics as of that block, so they stay valid if the blocks
+    // are disconnected while this runs
+    for (const CRollbackBlock &rollbackBlock : rollback)
+    {
+        boost::this_thread::interruption_point();
+        if (ShutdownRequested())
+        {
+            strError = "Shutting down";
+            return false;
+        }
+
+        CBlock block;
+        CBlockUndo blockundo;
+        if (!ReadBlockFromDisk(rollbackBlock.pindex->GetHeight(), block, rollbackBlock.blockPos, Params().GetConsensus(), false) ||
+            block.GetHash() != rollbackBlock.pindex->GetBlockHash() ||
+            !UndoReadFromDisk(blockundo, rollbackBlock.undoPos, rollbackBlock.prevHash) ||
+            blockundo.vtxundo.size() + 1 != block.vtx.size())
+        {
+            strError = strprintf("Block or undo data not available for block %s at height %d", rollbackBlock.pindex->GetBlockHash().GetHex(), rollbackBlock.pindex->GetHeight());
+            return false;
+        }
+        UpdateUTXOStats(block, blockundo, value, false);
+        if (!pblocktree->WriteUTXOStatsIndex(rollbackBlock.prevHash, value))
+        {
+            strError = "Failed to write UTXO stats index";
+            return false;
+        }
+    }
+    return true;
+}
+
+// start the UTXO stats index at the tip with one scan of the coins database, unless the tip already has an entry.
+// ConnectBlock extends it from there
+bool InitUTXOStatsIndex()
+{
+    LOCK(cs_main);
+
+    CUTXOStatsIndexValue utxoStats;
+    if (!chainActive.Tip() || GetUTXOStatsIndex(chainActive.Tip(), utxoStats))
+        return true;
+
+    CCoinsStats stats;
+    stats.fUTXOStats = true;
+    FlushStateToDisk();
+    if (!pcoinsTip->GetStats(stats) || stats.hashBlock != chainActive.Tip()->GetBlockHash())
+        return error("%s: unable to scan the coins database at %s", __func__, chainActive.Tip()->GetBlockHash().ToString());
+
+    return WriteUTXOStatsIndex(chainActive.Tip(), stats.utxoStats);
+}
+
 /**
  * Apply the undo operation of a CTxInUndo to the given chain state.
  * @param undo The undo object.
@@ -3261,6 +3618,139 @@ void SetMaxScriptElementSize(uint32_t height)
     }
 }
 
+typedef std::map<std::pair<unsigned int, uint160>, CAddressBalanceValue> CAddressBalanceDeltas;
+
+/** Sum the address index entries of one block into one balance change per address. Spent
+ *  reserve values come from the block's undo data, since the address index only carries
+ *  native amounts.
+ */
+static void GetAddressBalanceDeltas(const CBlock& block, const CBlockUndo& blockUndo,
+                                    const std::vector<CAddressIndexDbEntry>& addressIndex,
+                                    CAddressBalanceDeltas& deltas)
+{
+    std::set<std::pair<std::pair<unsigned int, uint160>, unsigned int>> txSeen;
+    for (auto &entry : addressIndex)
+    {
+        const CAddressIndexKey &key = entry.first;
+        std::pair<unsigned int, uint160> addressKey(key.type, key.hashBytes);
+        CAddressBalanceValue &delta = deltas[addressKey];
+
+        delta.balance += entry.second;
+        if (entry.second > 0)
+        {
+            delta.received += entry.second;
+        }
+        if (txSeen.insert(std::make_pair(addressKey, key.txindex)).second)
+        {
+            delta.txCount++;
+        }
+
+        if (key.spending)
+        {
+            if (key.txindex > 0 &&
+                key.txindex - 1 < blockUndo.vtxundo.size() &&
+                key.index < blockUndo.vtxundo[key.txindex - 1].vprevout.size())
+            {
+                CCurrencyValueMap reserves = blockUndo.vtxundo[key.txindex - 1].vprevout[key.index].txout.ReserveOutValue();
+                CAddressBalanceValue::AddCurrencyValues(delta.currencyBalance, reserves.valueMap, -1);
+            }
+        }
+        else if (key.txindex < block.vtx.size() && key.index < block.vtx[key.txindex].vout.size())
+        {
+            CCurrencyValueMap reserves = block.vtx[key.txindex].vout[key.index].ReserveOutValue();
+            CAddressBalanceValue::AddCurrencyValues(delta.currencyBalance, reserves.valueMap, 1);
+            CAddressBalanceValue::AddCurrencyValues(delta.currencyReceived, reserves.valueMap, 1);
+        }
+    }
+}
+
+/** Apply, or with a sign of -1 unwind, one block's address balance changes. Unlike the other
+ *  indexes, balances are running totals, so the index records the last block applied and a
+ *  block is only applied on top of its parent or unwound from itself. This keeps a replay of
+ *  blocks after an unclean shutdown from counting them twice.
+ */
+static bool UpdateAddressBalanceIndex(const CAddressBalanceDeltas& deltas, const CBlockIndex* pindex, int sign)
+{
+    uint256 hashExpected = sign > 0 ? (pindex->pprev ? pindex->pprev->GetBlockHash() : uint256()) : pindex->GetBlockHash();
+    uint256 hashBalanceBest;
+    if (pblocktree->ReadAddressBalanceBestBlock(hashBalanceBest) && hashBalanceBest != hashExpected)
+    {
+        LogPrint("addressindex", "%s: address balances at %s, skipping block %s\n", __func__, hashBalanceBest.GetHex(), pindex->GetBlockHash().GetHex());
+        return true;
+    }
+
+    std::vector<CAddressBalanceDbEntry> balanceIndex;
+    balanceIndex.reserve(deltas.size());
+    for (auto &oneDelta : deltas)
+    {
+        CAddressBalanceValue value;
+        pblocktree->ReadAddressBalanceIndex(oneDelta.first.second, oneDelta.first.first, value);
+        value.Add(oneDelta.second, sign);
+        balanceIndex.push_back(make_pair(CAddressIndexIteratorKey(oneDelta.first.first, oneDelta.first.second), value));
+    }
+    return pblocktree->UpdateAddressBalanceIndex(balanceIndex,
+                                                 sign > 0 ? pindex->GetBlockHash() : (pindex->pprev ? pindex->pprev->GetBlockHash() : uint256()));
+}
+
+/** Derive the per-currency entries for a block's changes to the address unspent index. Entries
+ *  that remove an output carry no script, so their values are found among the outputs the
+ *  block creates or, through the undo data, the outputs it spends.
+ */
+static void GetAddressUnspentCurrencyIndex(const CBlock& block, const CBlockUndo& blockUndo,
+                                           const std::vector<CAddressUnspentDbEntry>& addressUnspentIndex,
+                                           std::vector<CAddressUnspentCurrencyDbEntry>& currencyIndex)
+{
+    std::map<COutPoint, const CTxOut *> blockOutputs;
+    for (unsigned int i = 0; i < block.vtx.size(); i++)
+    {
+        const CTransaction &tx = block.vtx[i];
+        for (unsigned int k = 0; k < tx.vout.size(); k++)
+        {
+            blockOutputs[COutPoint(tx.GetHash(), k)] = &tx.vout[k];
+        }
+        if (i > 0 && i - 1 < blockUndo.vtxundo.size())
+        {
+            const CTxUndo &txundo = blockUndo.vtxundo[i - 1];
+            for (unsigned int j = 0; j < tx.vin.size() && j < txundo.vprevout.size(); j++)
+            {
+                blockOutputs[tx.vin[j].prevout] = &txundo.vprevout[j].txout;
+            }
+        }
+    }
+
+    for (auto &entry : addressUnspentIndex)
+    {
+        const CAddressUnspentKey &key = entry.first;
+        CCurrencyValueMap reserves;
+        if (!entry.second.IsNull())
+        {
+            reserves = entry.second.script.ReserveOutValue();
+        }
+        else
+        {
+            auto outIt = blockOutputs.find(COutPoint(key.txhash, key.index));
+            if (outIt == blockOutputs.end())
+            {
+                continue;
+            }
+            reserves = outIt->second->ReserveOutValue();
+        }
+
+        for (auto &oneCurrency : reserves.valueMap)
+        {
+            if (!oneCurrency.second)
+            {
+                continue;
+            }
+            currencyIndex.push_back(make_pair(
+                CAddressUnspentCurrencyKey(key.type, key.hashBytes, oneCurrency.first, key.txhash, key.index),
+                entry.second.IsNull() ?
+                    CAddressUnspentCurrencyValue() :
+                    CAddressUnspentCurrencyValue(entry.second.satoshis, reserves.valueMap, entry.second.blockHeight)));
+        }
+    }
+}
+
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  When UNCLEAN or FAILED is returned, view is left in an indeterminate state.
  *  The addressIndex and spentIndex will be updated if requested.
@@ -3291,6 +3781,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
     std::vector<CAddressIndexDbEntry> addressIndex;
     std::vector<CAddressUnspentDbEntry> addressUnspentIndex;
     std::vector<CSpentIndexDbEntry> spentIndex;
+    std::vector<CIdentityUnspentIndexDbEntry> identityUnspentIndex;
 
     uint32_t nHeight = pindex->GetHeight();
 
@@ -3299,6 +3790,22 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
         const CTransaction &tx = block.vtx[i];
         uint256 const hash = tx.GetHash();
 
+        if (fIdentityUnspentIndex && updateIndices) {
+            for (unsigned int k = tx.vout.size(); k-- > 0;) {
+                COptCCParams p;
+                CIdentity identity;
+                if (tx.vout[k].scriptPubKey.IsPayToCryptoCondition(p) &&
+                    p.IsValid() &&
+                    p.evalCode == EVAL_IDENTITY_PRIMARY &&
+                    p.vData.size() &&
+                    (identity = CIdentity(p.vData[0])).IsValid())
+                {
+                    // remove it, and if this was an update, the identity it spent is restored below
+                    identityUnspentIndex.push_back(make_pair(identity.GetID(), CIdentityUnspentIndexValue()));
+                }
+            }
+        }
+
         if (fAddressIndex && updateIndices) {
             for (unsigned int k = tx.vout.size(); k-- > 0;) {
 
@@ -3410,8 +3917,30 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
                     fClean = false;
 
                 const CTxIn input = tx.vin[j];
+                if (fIdentityUnspentIndex && updateIndices) {
+                    const CCoins *prevCoins = view.AccessCoins(out.hash);
+                    COptCCParams p;
+                    CIdentity identity;
+                    if (prevCoins &&
+                        prevCoins->IsAvailable(out.n) &&
+                        prevCoins->vout[out.n].scriptPubKey.IsPayToCryptoCondition(p) &&
+                        p.IsValid() &&
+                        p.evalCode == EVAL_IDENTITY_PRIMARY &&
+                        p.vData.size() &&
+                        (identity = CIdentity(p.vData[0])).IsValid())
+                    {
+                        // restore the prior state of an updated identity
+                        identityUnspentIndex.push_back(make_pair(identity.GetID(),
+                                                                 CIdentityUnspentIndexValue(out.hash, out.n, prevCoins->nHeight, p.vData[0])));
+                    }
+                }
                 if (fAddressIndex && updateIndices) {
                     const CTxOut &prevout = view.GetOutputFor(input);
+                    // the undo data only records a height when the spend emptied the prior transaction
+                    const CCoins *prevCoins = view.AccessCoins(input.prevout.hash);
+                    int prevHeight = prevCoins ? prevCoins->nHeight : undo.nHeight;
+                    const CBlockIndex *pPrevIndex = prevHeight > 0 ? pindex->GetAncestor(prevHeight) : NULL;
+                    uint256 prevBlockHash = pPrevIndex ? pPrevIndex->GetBlockHash() : uint256();
 
                     COptCCParams p;
                     if (prevout.scriptPubKey.IsPayToCryptoCondition(p))
@@ -3452,7 +3981,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
                                 // restore unspent index
                                 addressUnspentIndex.push_back(make_pair(
                                     CAddressUnspentKey(AddressTypeFromDest(dest), destID, input.prevout.hash, input.prevout.n),
-                                    CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undo.nHeight)));
+                                    CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, prevHeight, prevHeight, prevBlockHash)));
                             }
                         }
                     }
@@ -3472,7 +4001,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
                                 // restore unspent index
                                 addressUnspentIndex.push_back(make_pair(
                                     CAddressUnspentKey(scriptType, addrHash, input.prevout.hash, input.prevout.n),
-                                    CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undo.nHeight)));
+                                    CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, prevHeight, prevHeight, prevBlockHash)));
                             }
                         }
                     }
@@ -3527,6 +4056,31 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
             return DISCONNECT_FAILED;
         }
     }
+    if (fIdentityUnspentIndex && updateIndices) {
+        if (!pblocktree->UpdateIdentityUnspentIndex(identityUnspentIndex)) {
+            AbortNode(state, "Failed to write identity unspent index");
+            return DISCONNECT_FAILED;
+        }
+    }
+    if (fAddressCurrencyIndex && fAddressIndex && updateIndices) {
+        std::vector<CAddressUnspentCurrencyDbEntry> currencyIndex;
+        GetAddressUnspentCurrencyIndex(block, blockUndo, addressUnspentIndex, currencyIndex);
+        if (!pblocktree->UpdateAddressUnspentCurrencyIndex(currencyIndex)) {
+            AbortNode(state, "Failed to write address currency index");
+            return DISCONNECT_FAILED;
+        }
+    }
+    if (fAddressBalanceIndex && fAddressIndex && updateIndices) {
+        CAddressBalanceDeltas balanceDeltas;
+        GetAddressBalanceDeltas(block, blockUndo, addressIndex, balanceDeltas);
+        if (!UpdateAddressBalanceIndex(balanceDeltas, pindex, -1)) {
+            AbortNode(state, "Failed to write address balance index");
+            return DISCONNECT_FAILED;
+        }
+    }
+    // identity lookups cached before these index updates may be stale
+    IdentityCache.Clear();
+
     // unwind any consensus upgrades that may have been removed in the block
     ConnectedChains.CheckOracleUpgrades();
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
@@ -3564,6 +4118,20 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CHeaderHashCheck> headerhashqueue(8);
+
+void ThreadHeaderHashCheck() {
+    RenameThread("verus-hdrhash");
+    headerhashqueue.Thread();
+}
+
+static CCheckQueue<CSaplingProofCheck> saplingproofqueue(4);
+
+void ThreadSaplingProofCheck() {
+    RenameThread("verus-zproof");
+    saplingproofqueue.Thread();
+}
+
 //
 // Called periodically asynchronously; alerts if it smells like
 // we're being fed a bad chain (blocks being generated much
@@ -3722,6 +4290,33 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     std::vector<CAddressIndexDbEntry> addressIndex;
     std::vector<CAddressUnspentDbEntry> addressUnspentIndex;
     std::vector<CSpentIndexDbEntry> spentIndex;
+    std::vector<CIdentityUnspentIndexDbEntry> identityUnspentIndex;
+
+    // Sapling proofs are the most expensive part of checking shielded transactions, so verify those of the block's
+    // transactions that were not verified on mempool acceptance on the check threads first. ContextualCheckTransaction
+    // then finds them in the proof cache, and any failure is reported by it in order with the right reject reason.
+    if (nScriptCheckThreads)
+    {
+        CCheckQueueControl<CSaplingProofCheck> proofControl(&saplingproofqueue);
+        std::vector<CSaplingProofCheck> vProofChecks;
+        for (auto &tx : block.vtx)
+        {
+            uint256 dataToBeSigned, entry;
+            if ((tx.vShieldedSpend.empty() && tx.vShieldedOutput.empty()) ||
+                tx.IsMint() ||
+                !GetShieldedDataToBeSigned(tx, chainparams, nHeight, dataToBeSigned))
+            {
+                continue;
+            }
+            saplingProofCache.ComputeEntry(entry, tx.GetHash(), dataToBeSigned);
+            if (!saplingProofCache.Get(entry))
+            {
+                vProofChecks.push_back(CSaplingProofCheck(tx, dataToBeSigned));
+            }
+        }
+        proofControl.Add(vProofChecks);
+        proofControl.Wait();
+    }
 
     CCheckQueueControl<CScriptCheck> control(fExpensiveChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
     CCurrencyDefinition newThisChain;
@@ -3960,7 +4555,14 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             }
             state = CValidationState();
 
-            CReserveTransactionDescriptor rtxd(tx, view, nHeight);
+            // the descriptor depends on chain state, so one computed on acceptance is only reused if it was
+            // computed for this height on top of this block's parent
+            CReserveTransactionDescriptor rtxd;
+            if (!mempool.GetReserveDescriptor(txhash, rtxd, nHeight, pindex->pprev ? pindex->pprev->GetBlockHash() : uint256()))
+            {
+                rtxd = CReserveTransactionDescriptor(tx, view, nHeight);
+            }
+            rtxd.ptx = &tx;
             if (rtxd.IsReject())
             {
                 return state.DoS(100, error(strprintf("%s: Invalid reserve transaction", __func__).c_str()), REJECT_INVALID, "bad-txns-invalid-reserve");
@@ -4619,7 +5221,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                                     // record unspent output
                                     addressUnspentIndex.push_back(make_pair(
                                         CAddressUnspentKey(AddressTypeFromDest(dest), destID, txhash, k),
-                                        CAddressUnspentValue(out.nValue, out.scriptPubKey, heightOffsets[destID])));
+                                        CAddressUnspentValue(out.nValue, out.scriptPubKey, heightOffsets[destID], nHeight, pindex->GetBlockHash())));
                                 }
                                 else
                                 {
@@ -4631,7 +5233,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                                     // record unspent output
                                     addressUnspentIndex.push_back(make_pair(
                                         CAddressUnspentKey(AddressTypeFromDest(dest), destID, txhash, k),
-                                        CAddressUnspentValue(out.nValue, out.scriptPubKey, nHeight)));
+                                        CAddressUnspentValue(out.nValue, out.scriptPubKey, nHeight, nHeight, pindex->GetBlockHash())));
                                 }
                             }
                         }
@@ -4653,13 +5255,30 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                                 // record unspent output
                                 addressUnspentIndex.push_back(make_pair(
                                     CAddressUnspentKey(scriptType, addrHash, txhash, k),
-                                    CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->GetHeight())));
+                                    CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->GetHeight(), pindex->GetHeight(), pindex->GetBlockHash())));
                             }
                         }
                     }
                 }
             }
 
+            if (fIdentityUnspentIndex) {
+                for (unsigned int k = 0; k < tx.vout.size(); k++) {
+                    COptCCParams p;
+                    CIdentity identity;
+                    if (tx.vout[k].scriptPubKey.IsPayToCryptoCondition(p) &&
+                        p.IsValid() &&
+                        p.evalCode == EVAL_IDENTITY_PRIMARY &&
+                        p.vData.size() &&
+                        (identity = CIdentity(p.vData[0])).IsValid())
+                    {
+                        // later updates in the same block replace earlier ones when the batch is written
+                        identityUnspentIndex.push_back(make_pair(identity.GetID(),
+                                                                 CIdentityUnspentIndexValue(txhash, k, nHeight, p.vData[0])));
+                    }
+                }
+            }
+
             CTxUndo undoDummy;
             if (i > 0) {
                 blockundo.vtxundo.push_back(CTxUndo());
@@ -4882,6 +5501,46 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
         if (!pblocktree->UpdateSpentIndex(spentIndex))
             return AbortNode(state, "Failed to write transaction index");
 
+    if (fIdentityUnspentIndex)
+        if (!pblocktree->UpdateIdentityUnspentIndex(identityUnspentIndex))
+            return AbortNode(state, "Failed to write identity unspent index");
+
+    // extend the coin supply index if the parent is indexed, taking spent input values from the undo data
+    {
+        CCoinSupplyIndexValue supplyValue;
+        if (GetBlockCoinSupply(pindex, block, blockundo, supplyValue) &&
+            !WriteCoinSupplyIndex(pindex, supplyValue))
+        {
+            return AbortNode(state, "Failed to write coin supply index");
+        }
+    }
+
+    // extend the UTXO set statistics if the parent's are indexed
+    if (fUTXOStatsIndex)
+    {
+        CUTXOStatsIndexValue utxoStats;
+        if (GetUTXOStatsIndex(pindex->pprev, utxoStats))
+        {
+            UpdateUTXOStats(block, blockundo, utxoStats, true);
+            if (!WriteUTXOStatsIndex(pindex, utxoStats))
+                return AbortNode(state, "Failed to write UTXO stats index");
+        }
+    }
+
+    if (fAddressCurrencyIndex && fAddressIndex) {
+        std::vector<CAddressUnspentCurrencyDbEntry> currencyIndex;
+        GetAddressUnspentCurrencyIndex(block, blockundo, addressUnspentIndex, currencyIndex);
+        if (!pblocktree->UpdateAddressUnspentCurrencyIndex(currencyIndex))
+            return AbortNode(state, "Failed to write address currency index");
+    }
+
+    if (fAddressBalanceIndex && fAddressIndex) {
+        CAddressBalanceDeltas balanceDeltas;
+        GetAddressBalanceDeltas(block, blockundo, addressIndex, balanceDeltas);
+        if (!UpdateAddressBalanceIndex(balanceDeltas, pindex, 1))
+            return AbortNode(state, "Failed to write address balance index");
+    }
+
     if (fTimestampIndex) {
         unsigned int logicalTS = pindex->nTime;
         unsigned int prevLogicalTS = 0;
@@ -4939,6 +5598,9 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     }
     // END insightexplorer
 
+    // identity lookups cached before these index writes may be stale
+    IdentityCache.Clear();
+
     if (newThisChain.IsValid())
     {
         ConnectedChains.UpdateCachedCurrency(newThisChain, nHeight + 1);
@@ -5091,6 +5753,9 @@ void PruneAndFlush() {
 void static UpdateTip(CBlockIndex *pindexNew, const CChainParams& chainParams) {
     chainActive.SetTip(pindexNew);
 
+    // the coins view and tip height used by identity lookups changed with the tip
+    IdentityCache.Clear();
+
     // New best block
     nTimeBestReceived = GetTime();
     mempool.AddTransactionsUpdated(1);
@@ -5274,6 +5939,8 @@ static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
 static int64_t nTimePostConnect = 0;
+static uint64_t nScriptDecodesTotal = 0;
+static uint64_t nScriptDecodesReusedTotal = 0;
 
 /**
  * Connect a new block to chainActive. pblock is either NULL or a pointer to a CBlock
@@ -5293,6 +5960,9 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     }
     KOMODO_CONNECTING = (int32_t)pindexNew->GetHeight();
 
+    // output scripts of this block are parsed once, from connect through wallet sync
+    CBlockScriptCache scriptCache;
+
     // Get the current commitment tree
     SproutMerkleTree oldSproutTree;
     SaplingMerkleTree oldSaplingTree;
@@ -5355,6 +6025,9 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     int64_t nTime6 = GetTimeMicros(); nTimePostConnect += nTime6 - nTime5; nTimeTotal += nTime6 - nTime1;
     LogPrint("bench", "  - Connect postprocess: %.2fms [%.2fs]\n", (nTime6 - nTime5) * 0.001, nTimePostConnect * 0.000001);
     LogPrint("bench", "- Connect block: %.2fms [%.2fs]\n", (nTime6 - nTime1) * 0.001, nTimeTotal * 0.000001);
+    nScriptDecodesTotal += scriptCache.nDecoded;
+    nScriptDecodesReusedTotal += scriptCache.nReused;
+    LogPrint("bench", "- Script decodes: %u, reused %u [%u, reused %u]\n", scriptCache.nDecoded, scriptCache.nReused, nScriptDecodesTotal, nScriptDecodesReusedTotal);
     if ( KOMODO_LONGESTCHAIN != 0 && pindexNew->GetHeight() >= KOMODO_LONGESTCHAIN )
         KOMODO_INSYNC = 1;
     else KOMODO_INSYNC = 0;
@@ -5707,7 +6380,7 @@ bool InvalidateBlock(CValidationState& state, const CChainParams& chainparams, C
             return false;
         }
     }
-    //LimitMempoolSize(mempool, GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000, GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60);
+    LimitMempoolSize(mempool, GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000);
 
     // The resulting new best tip may not be in setBlockIndexCandidates anymore, so
     // add it again.
@@ -5758,10 +6431,10 @@ bool ReconsiderBlock(CValidationState& state, CBlockIndex *pindex) {
     return true;
 }
 
-CBlockIndex* AddToBlockIndex(const CBlockHeader& block)
+CBlockIndex* AddToBlockIndex(const CBlockHeader& block, const uint256 *pBlockHash=NULL)
 {
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    uint256 hash = pBlockHash ? *pBlockHash : block.GetHash();
     //printf("Hash of new index entry: %s\n\n", hash.GetHex().c_str());
 
     BlockMap::iterator it = mapBlockIndex.find(hash);
@@ -6195,10 +6868,10 @@ bool CheckBlock(int32_t *futureblockp,int32_t height,CBlockIndex *pindex,const C
 
 bool ContextualCheckBlockHeader(
     const CBlockHeader& block, CValidationState& state,
-    const CChainParams& chainParams, CBlockIndex * const pindexPrev)
+    const CChainParams& chainParams, CBlockIndex * const pindexPrev, const uint256 *pBlockHash)
 {
     const Consensus::Params& consensusParams = chainParams.GetConsensus();
-    uint256 hash = block.GetHash();
+    uint256 hash = pBlockHash ? *pBlockHash : block.GetHash();
     if (hash == consensusParams.hashGenesisBlock)
         return true;
 
@@ -6408,20 +7081,20 @@ bool ContextualCheckBlock(
     return true;
 }
 
-static bool AcceptBlockHeader(int32_t *futureblockp,const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex=NULL)
+static bool AcceptBlockHeader(int32_t *futureblockp,const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex=NULL, const uint256 *pBlockHash=NULL)
 {
     static uint256 zero;
     AssertLockHeld(cs_main);
 
-    // Check for duplicate
-    uint256 hash = block.GetHash();
+    // Check for duplicate, using the hash if the caller already computed it
+    uint256 hash = pBlockHash ? *pBlockHash : block.GetHash();
     BlockMap::iterator miSelf = mapBlockIndex.find(hash);
     CBlockIndex *pindex = NULL;
     if (miSelf != mapBlockIndex.end())
     {
         // Block header is already known.
         if ( (pindex = miSelf->second) == 0 )
-            miSelf->second = pindex = AddToBlockIndex(block);
+            miSelf->second = pindex = AddToBlockIndex(block, &hash);
         if (ppindex)
             *ppindex = pindex;
         if ( pindex != 0 && pindex->nStatus & BLOCK_FAILED_MASK )
@@ -6469,7 +7142,7 @@ static bool AcceptBlockHeader(int32_t *futureblockp,const CBlockHeader& block, C
         if ( (pindexPrev->nStatus & BLOCK_FAILED_MASK) )
             return state.DoS(100, error("%s: prev block invalid", __func__), REJECT_INVALID, "bad-prevblk");
     }
-    if (!ContextualCheckBlockHeader(block, state, chainparams, pindexPrev))
+    if (!ContextualCheckBlockHeader(block, state, chainparams, pindexPrev, &hash))
     {
         //fprintf(stderr,"AcceptBlockHeader ContextualCheckBlockHeader failed\n");
         LogPrintf("AcceptBlockHeader ContextualCheckBlockHeader failed\n");
@@ -6477,7 +7150,7 @@ static bool AcceptBlockHeader(int32_t *futureblockp,const CBlockHeader& block, C
     }
     if (pindex == NULL)
     {
-        if ( (pindex= AddToBlockIndex(block)) != 0 )
+        if ( (pindex= AddToBlockIndex(block, &hash)) != 0 )
         {
             miSelf = mapBlockIndex.find(hash);
             if (miSelf != mapBlockIndex.end())
@@ -7100,6 +7773,15 @@ bool static LoadBlockIndexDB()
     pblocktree->ReadFlag("idindex", fIdIndex);
     LogPrintf("%s: identity index %s\n", __func__, fIdIndex ? "enabled" : "disabled");
 
+    pblocktree->ReadFlag("idunspentindex", fIdentityUnspentIndex);
+    LogPrintf("%s: identity unspent index %s\n", __func__, fIdentityUnspentIndex ? "enabled" : "disabled");
+
+    pblocktree->ReadFlag("addressbalanceindex", fAddressBalanceIndex);
+    LogPrintf("%s: address balance index %s\n", __func__, fAddressBalanceIndex ? "enabled" : "disabled");
+
+    pblocktree->ReadFlag("addresscurrencyindex", fAddressCurrencyIndex);
+    LogPrintf("%s: address currency index %s\n", __func__, fAddressCurrencyIndex ? "enabled" : "disabled");
+
     // Check whether we have an address index
     pblocktree->ReadFlag("addressindex", fAddressIndex);
     LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
@@ -7518,6 +8200,18 @@ bool InitBlockIndex(const CChainParams& chainparams)
     fIdIndex = GetBoolArg("-idindex", false);
     pblocktree->WriteFlag("idindex", fIdIndex);
 
+    // Use the provided setting for -idunspentindex in the new database
+    fIdentityUnspentIndex = GetBoolArg("-idunspentindex", false);
+    pblocktree->WriteFlag("idunspentindex", fIdentityUnspentIndex);
+
+    // Use the provided setting for -addressbalanceindex in the new database
+    fAddressBalanceIndex = GetBoolArg("-addressbalanceindex", false);
+    pblocktree->WriteFlag("addressbalanceindex", fAddressBalanceIndex);
+
+    // Use the provided setting for -addresscurrencyindex in the new database
+    fAddressCurrencyIndex = GetBoolArg("-addresscurrencyindex", false);
+    pblocktree->WriteFlag("addresscurrencyindex", fAddressCurrencyIndex);
+
     // Use the provided setting for -addressindex in the new database
     fAddressIndex = true;
     pblocktree->WriteFlag("addressindex", fAddressIndex);
@@ -8841,15 +9535,36 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
-        LOCK(cs_main);
-
         if (nCount == 0) {
             // Nothing interesting. Stop asking this peers for more headers.
             return true;
         }
 
+        // hashing the headers is the expensive part of accepting them and needs no chain state,
+        // so hash them all on the check threads before taking cs_main and accepting them in order
+        std::vector<uint256> headerHashes(nCount);
+        {
+            CCheckQueueControl<CHeaderHashCheck> control(nScriptCheckThreads ? &headerhashqueue : NULL);
+            std::vector<CHeaderHashCheck> vChecks;
+            vChecks.reserve(nCount);
+            for (unsigned int n = 0; n < nCount; n++) {
+                vChecks.push_back(CHeaderHashCheck(headers[n], headerHashes[n]));
+            }
+            if (nScriptCheckThreads) {
+                control.Add(vChecks);
+                control.Wait();
+            } else {
+                BOOST_FOREACH(CHeaderHashCheck& check, vChecks) {
+                    check();
+                }
+            }
+        }
+
+        LOCK(cs_main);
+
         CBlockIndex *pindexLast = NULL;
-        BOOST_FOREACH(const CBlockHeader& header, headers) {
+        for (unsigned int n = 0; n < nCount; n++) {
+            const CBlockHeader& header = headers[n];
             /*
             auto lastIndex = mapBlockIndex.find(header.hashPrevBlock);
             auto thisIndex = mapBlockIndex.find(header.GetHash());
@@ -8906,7 +9621,7 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
                 return error("non-continuous headers sequence");
             }
             int32_t futureblock;
-            if (!AcceptBlockHeader(&futureblock, header, state, chainparams, &pindexLast)) {
+            if (!AcceptBlockHeader(&futureblock, header, state, chainparams, &pindexLast, &headerHashes[n])) {
                 int nDoS;
                 if (state.IsInvalid(nDoS) && (futureblock == 0 || nDoS >= 100))
                 {
@@ -24,6 +24,9 @@
 #include "script/standard.h"
 #include "script/script_ext.h"
 #include "spentindex.h"
+#include "identityindex.h"
+#include "coinsupplyindex.h"
+#include "utxostatsindex.h"
 #include "sync.h"
 #include "tinyformat.h"
 #include "txdb.h"
@@ -46,6 +49,7 @@
 
 class CBlockIndex;
 class CBlockTreeDB;
+class CBlockUndo;
 class CBloomFilter;
 class CChainParams;
 class CInv;
@@ -56,6 +60,16 @@ class PrecomputedTransactionData;
 
 struct CNodeStateStats;
 #define DEFAULT_MEMPOOL_EXPIRY 1
+/** Default for -maxmempool, maximum megabytes of mempool memory usage */
+static const unsigned int DEFAULT_MAX_MEMPOOL_SIZE = 300;
+/** Default for -limitancestorcount, max number of in-mempool ancestors */
+static const unsigned int DEFAULT_ANCESTOR_LIMIT = 25;
+/** Default for -limitancestorsize, maximum kilobytes of tx + all in-mempool ancestors */
+static const unsigned int DEFAULT_ANCESTOR_SIZE_LIMIT = 101;
+/** Default for -limitdescendantcount, max number of in-mempool descendants */
+static const unsigned int DEFAULT_DESCENDANT_LIMIT = 25;
+/** Default for -limitdescendantsize, maximum kilobytes of in-mempool descendants */
+static const unsigned int DEFAULT_DESCENDANT_SIZE_LIMIT = 101;
 #define _COINBASE_MATURITY 100
 
 /** Default for -blockmaxsize and -blockminsize, which control the range of sizes the mining code will create **/
@@ -92,6 +106,8 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Number of transactions whose verified Sapling proofs are remembered */
+static const size_t MAX_SAPLING_PROOF_CACHE_ENTRIES = 50000;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -131,6 +147,7 @@ static const unsigned int INVENTORY_BROADCAST_MAX = 7 * INVENTORY_BROADCAST_INTE
 #define DEFAULT_ADDRESSINDEX (GetArg("-ac_cc",0) != 0 || GetArg("-ac_ccactivate",0) != 0)
 #define DEFAULT_SPENTINDEX (GetArg("-ac_cc",0) != 0 || GetArg("-ac_ccactivate",0) != 0)
 static const bool DEFAULT_TIMESTAMPINDEX = false;
+static const bool DEFAULT_UTXOSTATSINDEX = false;
 static const unsigned int DEFAULT_DB_MAX_OPEN_FILES = 1000;
 static const bool DEFAULT_DB_COMPRESSION = true;
 
@@ -165,6 +182,10 @@ extern bool fReindex;
 extern int nScriptCheckThreads;
 extern bool fTxIndex;
 extern bool fIdIndex;
+extern bool fIdentityUnspentIndex;
+extern bool fAddressBalanceIndex;
+extern bool fAddressCurrencyIndex;
+extern bool fUTXOStatsIndex;
 
 // START insightexplorer
 extern bool fInsightExplorer;
@@ -266,6 +287,10 @@ bool ProcessMessages(CNode* pfrom);
 bool SendMessages(CNode* pto, bool fSendTrickle);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the block header hashing thread */
+void ThreadHeaderHashCheck();
+/** Run an instance of the Sapling proof verification thread */
+void ThreadSaplingProofCheck();
 /** Try to detect Partition (network isolation) attacks against us */
 void PartitionCheck(bool (*initialDownloadCheck)(const CChainParams&), CCriticalSection& cs, const CBlockIndex *const &bestHeader);
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
@@ -316,6 +341,9 @@ void FlushStateToDisk();
 /** Prune block files and flush state to disk. */
 void PruneAndFlush();
 
+/** Check the in-mempool ancestor and descendant packages a transaction would join against the -limit* options.
+ *  Exports, imports and notarizations are not limited. pool.cs must be held. */
+bool CheckMemPoolPackageLimits(const CTxMemPool &pool, const CTxMemPoolEntry &entry, const CReserveTransactionDescriptor &txDesc, std::string &errString);
 /** (try to) add transaction to memory pool **/
 bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransaction &tx, bool fLimitFree,
                         bool* pfMissingInputs, bool fRejectAbsurdFee=false, int dosLevel=-1);
@@ -480,16 +508,87 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure computing the PoW hash of one block header, so the headers of a
+ * "headers" message can be hashed in parallel before they are accepted in order.
+ * Note that this stores references to the header and the hash it fills in
+ */
+class CHeaderHashCheck
+{
+private:
+    const CBlockHeader *pheader;
+    uint256 *phash;
+
+public:
+    CHeaderHashCheck(): pheader(NULL), phash(NULL) {}
+    CHeaderHashCheck(const CBlockHeader &headerIn, uint256 &hashOut) : pheader(&headerIn), phash(&hashOut) {}
+
+    bool operator()()
+    {
+        *phash = pheader->GetHash();
+        return true;
+    }
+
+    void swap(CHeaderHashCheck &check) {
+        std::swap(pheader, check.pheader);
+        std::swap(phash, check.phash);
+    }
+};
+
+/**
+ * Closure verifying the Sapling spend and output proofs and the binding signature
+ * of one transaction. Successful checks are remembered, so ContextualCheckTransaction
+ * does not verify the same transaction again.
+ * Note that this stores a reference to the transaction
+ */
+class CSaplingProofCheck
+{
+private:
+    const CTransaction *ptx;
+    uint256 dataToBeSigned;
+    const char *strError;
+    const char *strRejectReason;
+
+public:
+    CSaplingProofCheck(): ptx(NULL), strError(""), strRejectReason("") {}
+    CSaplingProofCheck(const CTransaction &txIn, const uint256 &dataToBeSignedIn) :
+        ptx(&txIn), dataToBeSigned(dataToBeSignedIn), strError(""), strRejectReason("") {}
+
+    bool operator()();
+
+    void swap(CSaplingProofCheck &check) {
+        std::swap(ptx, check.ptx);
+        std::swap(dataToBeSigned, check.dataToBeSigned);
+        std::swap(strError, check.strError);
+        std::swap(strRejectReason, check.strRejectReason);
+    }
+
+    const char *GetError() const { return strError; }
+    const char *GetRejectReason() const { return strRejectReason; }
+};
+
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes);
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-bool GetAddressIndex(const uint160& addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0);
-bool GetAddressUnspent(const uint160& addressHash, int type, std::vector<CAddressUnspentDbEntry>& unspentOutputs);
+bool GetIdentityUnspent(const uint160 &identityID, CIdentityUnspentIndexValue &value);
+bool GetCoinSupplyIndex(const CBlockIndex *pindex, CCoinSupplyIndexValue &value);
+bool WriteCoinSupplyIndex(const CBlockIndex *pindex, const CCoinSupplyIndexValue &value);
+bool GetBlockCoinSupply(const CBlockIndex *pindex, const CBlock &block, const CBlockUndo &blockundo, CCoinSupplyIndexValue &value);
+bool GetUTXOStatsIndex(const CBlockIndex *pindex, CUTXOStatsIndexValue &value);
+bool WriteUTXOStatsIndex(const CBlockIndex *pindex, const CUTXOStatsIndexValue &value);
+void UpdateUTXOStats(const CBlock &block, const CBlockUndo &blockundo, CUTXOStatsIndexValue &stats, bool fConnect);
+bool GetUTXOStats(const CBlockIndex *pindex, CUTXOStatsIndexValue &value, std::string &strError);
+bool InitUTXOStatsIndex();
+bool GetAddressBalance(const uint160& addressHash, int type, CAddressBalanceValue &value);
+bool GetAddressUnspentCurrency(const uint160& addressHash, int type, const uint160& currencyID, std::vector<CAddressUnspentCurrencyDbEntry>& unspentOutputs);
+bool GetAddressIndex(const uint160& addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0, CAddressIndexPage<CAddressIndexKey> *pPage = nullptr);
+bool GetAddressUnspent(const uint160& addressHash, int type, std::vector<CAddressUnspentDbEntry>& unspentOutputs, CAddressIndexPage<CAddressUnspentKey> *pPage = nullptr);
 
 /** Functions for disk access for blocks */
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
 bool ReadBlockFromDisk(int32_t height, CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams, bool checkPOW);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams, bool checkPOW);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+bool ReadBlockUndoFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -513,7 +612,7 @@ bool CheckBlock(int32_t *futureblockp,int32_t height,CBlockIndex *pindex,const C
  *  By "context", we mean only the previous block headers, but not the UTXO
  *  set; UTXO-related validity checks are done in ConnectBlock(). */
 bool ContextualCheckBlockHeader(const CBlockHeader& block, CValidationState& state,
-                                const CChainParams& chainparams, CBlockIndex *pindexPrev);
+                                const CChainParams& chainparams, CBlockIndex *pindexPrev, const uint256 *pBlockHash = NULL);
 bool ContextualCheckBlock(const CBlock& block, CValidationState& state,
                           const CChainParams& chainparams, CBlockIndex *pindexPrev);
 
@@ -80,6 +80,84 @@ public:
     }
 };
 
+//
+// CreateNewBlock is called repeatedly on the same tip by the miner loop and getblocktemplate,
+// and most of the mempool is unchanged between calls. CTemplateTxCache keeps the work done for
+// each mempool transaction that does not depend on the template being built: the contextual
+// check for the height being mined, the serialized size and, for transactions whose inputs are
+// all confirmed, the sums needed to recompute input priority at any later height.
+//
+// Entries are added as CreateNewBlock first sees a transaction and are swept once it leaves the
+// mempool. Confirmed inputs stay confirmed as long as the chain only extends, so the cache is
+// cleared when the tip it was built on is no longer in the active chain.
+//
+class CTemplateTxCache
+{
+public:
+    struct CTxInfo
+    {
+        int nContextCheckedHeight;  // height for which ContextualCheckTransaction passed, or 0
+        unsigned int nTxSize;       // serialized size, or 0 if not yet computed
+        bool fConfirmedInputs;      // true once the input sums below are valid
+        CAmount nValueIn;           // sum of confirmed input values
+        double dInputWeight;        // sum of (1 + value) over confirmed inputs
+        double dInputWeightHeight;  // sum of (1 + value) * coin height over confirmed inputs
+        bool fSeen;                 // seen in the current pass over the mempool
+
+        CTxInfo() : nContextCheckedHeight(0), nTxSize(0), fConfirmedInputs(false), nValueIn(0), dInputWeight(0), dInputWeightHeight(0), fSeen(false) {}
+
+        // sum((1 + value) * (nHeight - coinHeight)) as the full input loop computes it
+        double InputPriority(int nHeight) const
+        {
+            return dInputWeight * nHeight - dInputWeightHeight;
+        }
+    };
+
+    // returns the entry for a transaction, creating it if needed
+    CTxInfo &Get(const uint256 &hash)
+    {
+        return mapTxInfo[hash];
+    }
+
+    void StartPass(const CBlockIndex *pindexPrev)
+    {
+        if (!lastTipHash.IsNull() &&
+            lastTipHash != pindexPrev->GetBlockHash() &&
+            !(mapBlockIndex.count(lastTipHash) && chainActive.Contains(mapBlockIndex[lastTipHash])))
+        {
+            mapTxInfo.clear();
+        }
+        lastTipHash = pindexPrev->GetBlockHash();
+        for (auto &oneTx : mapTxInfo)
+        {
+            oneTx.second.fSeen = false;
+        }
+    }
+
+    // forget transactions that are no longer in the mempool
+    void EndPass()
+    {
+        for (auto it = mapTxInfo.begin(); it != mapTxInfo.end(); )
+        {
+            if (!it->second.fSeen)
+            {
+                it = mapTxInfo.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+private:
+    std::map<uint256, CTxInfo> mapTxInfo;
+    uint256 lastTipHash;
+};
+
+// protected by cs_main, which CreateNewBlock holds while it uses the cache
+static CTemplateTxCache templateTxCache;
+
 uint64_t nLastBlockTx = 0;
 uint64_t nLastBlockSize = 0;
 
@@ -2703,12 +2781,16 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
 
         std::list<CTransaction> txesToRemove;
 
+        templateTxCache.StartPass(pindexPrev);
+
         // now add transactions from the mem pool to the priority heap
         for (CTxMemPool::indexed_transaction_set::iterator mi = mempool.mapTx.begin();
              mi != mempool.mapTx.end(); ++mi)
         {
             const CTransaction& tx = mi->GetTx();
             uint256 hash = tx.GetHash();
+            CTemplateTxCache::CTxInfo &txInfo = templateTxCache.Get(hash);
+            txInfo.fSeen = true;
 
             int64_t nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST)
             ? nMedianTimePast
@@ -2723,11 +2805,13 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
             if (tx.IsCoinBase() ||
                 IsExpiredTx(tx, nHeight) ||
                 (mi->GetHeight() != nHeight &&
+                 txInfo.nContextCheckedHeight != nHeight &&
                  !ContextualCheckTransaction(tx, state, Params(), nHeight, 0)))
             {
                 txesToRemove.push_back(tx);
                 continue;
             }
+            txInfo.nContextCheckedHeight = nHeight;
 
             COrphan* porphan = NULL;
             double dPriority = 0;
@@ -3097,60 +3181,86 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
                 }
             }
 
-            BOOST_FOREACH(const CTxIn& txin, tx.vin)
-            {
-                CAmount nValueIn = 0;
-                CCurrencyValueMap reserveValueIn;
+            // reserve transactions value their inputs at the current currency state, so only
+            // native transactions can reuse the input sums from an earlier template
+            bool fCacheInputs = !isReserve && !txInfo.fConfirmedInputs;
+            CAmount nCachedValueIn = 0;
+            double dCachedWeight = 0, dCachedWeightHeight = 0;
 
-                // Read prev transaction
-                if (!view.HaveCoins(txin.prevout.hash))
+            if (!isReserve && txInfo.fConfirmedInputs)
+            {
+                nTotalIn += txInfo.nValueIn;
+                dPriority += txInfo.InputPriority(nHeight);
+            }
+            else
+            {
+                BOOST_FOREACH(const CTxIn& txin, tx.vin)
                 {
-                    // This should never happen; all transactions in the memory
-                    // pool should connect to either transactions in the chain
-                    // or other transactions in the memory pool.
-                    if (!mempool.mapTx.count(txin.prevout.hash))
-                    {
-                        LogPrintf("ERROR: mempool transaction missing input\n");
-                        if (fDebug) assert("mempool transaction missing input" == 0);
-                        fMissingInputs = true;
-                        if (porphan)
-                            vOrphan.pop_back();
-                        break;
-                    }
+                    CAmount nValueIn = 0;
+                    CCurrencyValueMap reserveValueIn;
 
-                    // Has to wait for dependencies
-                    if (!porphan)
+                    // Read prev transaction
+                    if (!view.HaveCoins(txin.prevout.hash))
                     {
-                        // Use list for automatic deletion
-                        vOrphan.push_back(COrphan(&tx));
-                        porphan = &vOrphan.back();
+                        // This should never happen; all transactions in the memory
+                        // pool should connect to either transactions in the chain
+                        // or other transactions in the memory pool.
+                        if (!mempool.mapTx.count(txin.prevout.hash))
+                        {
+                            LogPrintf("ERROR: mempool transaction missing input\n");
+                            if (fDebug) assert("mempool transaction missing input" == 0);
+                            fMissingInputs = true;
+                            if (porphan)
+                                vOrphan.pop_back();
+                            break;
+                        }
+
+                        // Has to wait for dependencies
+                        fCacheInputs = false;
+                        if (!porphan)
+                        {
+                            // Use list for automatic deletion
+                            vOrphan.push_back(COrphan(&tx));
+                            porphan = &vOrphan.back();
+                        }
+                        mapDependers[txin.prevout.hash].push_back(porphan);
+                        porphan->setDependsOn.insert(txin.prevout.hash);
+
+                        const CTransaction &otx = mempool.mapTx.find(txin.prevout.hash)->GetTx();
+                        // consider reserve outputs and set priority according to their value here as well
+                        if (isReserve)
+                        {
+                            totalReserveIn += otx.vout[txin.prevout.n].ReserveOutValue();
+                        }
+                        nTotalIn += otx.vout[txin.prevout.n].nValue;
+                        continue;
                     }
-                    mapDependers[txin.prevout.hash].push_back(porphan);
-                    porphan->setDependsOn.insert(txin.prevout.hash);
+                    const CCoins* coins = view.AccessCoins(txin.prevout.hash);
+                    assert(coins);
 
-                    const CTransaction &otx = mempool.mapTx.find(txin.prevout.hash)->GetTx();
-                    // consider reserve outputs and set priority according to their value here as well
                     if (isReserve)
                     {
-                        totalReserveIn += otx.vout[txin.prevout.n].ReserveOutValue();
+                        reserveValueIn = coins->vout[txin.prevout.n].ReserveOutValue();
+                        totalReserveIn += reserveValueIn;
                     }
-                    nTotalIn += otx.vout[txin.prevout.n].nValue;
-                    continue;
-                }
-                const CCoins* coins = view.AccessCoins(txin.prevout.hash);
-                assert(coins);
 
-                if (isReserve)
-                {
-                    reserveValueIn = coins->vout[txin.prevout.n].ReserveOutValue();
-                    totalReserveIn += reserveValueIn;
-                }
+                    nValueIn = coins->vout[txin.prevout.n].nValue;
+                    int nConf = nHeight - coins->nHeight;
 
-                nValueIn = coins->vout[txin.prevout.n].nValue;
-                int nConf = nHeight - coins->nHeight;
+                    dPriority += ((double)((reserveValueIn.valueMap.size() ? currencyState.ReserveToNative(reserveValueIn) : 1) + nValueIn)) * nConf;
+                    nTotalIn += nValueIn;
 
-                dPriority += ((double)((reserveValueIn.valueMap.size() ? currencyState.ReserveToNative(reserveValueIn) : 1) + nValueIn)) * nConf;
-                nTotalIn += nValueIn;
+                    nCachedValueIn += nValueIn;
+                    dCachedWeight += (double)(1 + nValueIn);
+                    dCachedWeightHeight += (double)(1 + nValueIn) * coins->nHeight;
+                }
+            }
+            if (fCacheInputs && !fMissingInputs)
+            {
+                txInfo.fConfirmedInputs = true;
+                txInfo.nValueIn = nCachedValueIn;
+                txInfo.dInputWeight = dCachedWeight;
+                txInfo.dInputWeightHeight = dCachedWeightHeight;
             }
             // prioritize notarizations, finalizations, and exports for our notary chain
             if (rtxd.IsNotaryPrioritized() || rtxd.IsExport())
@@ -3163,7 +3273,11 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
             if (fMissingInputs) continue;
 
             // Priority is sum(valuein * age) / modified_txsize
-            unsigned int nTxSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
+            if (!txInfo.nTxSize)
+            {
+                txInfo.nTxSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
+            }
+            unsigned int nTxSize = txInfo.nTxSize;
             dPriority = tx.ComputePriority(dPriority, nTxSize);
 
             CAmount nDeltaValueIn = nTotalIn + (totalReserveIn.valueMap.count(VERUS_CHAINID) ? totalReserveIn.valueMap[VERUS_CHAINID] : 0);
@@ -3172,6 +3286,17 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
 
             CFeeRate feeRate(nFeeValueIn - (tx.GetValueOut() + delayedFee), nTxSize);
 
+            // a transaction whose in-mempool descendants pay a higher rate as a package is sorted at
+            // that rate, so children can pay for their parents, such as an import spending a transfer
+            if (mi->GetCountWithDescendants() > 1)
+            {
+                CFeeRate packageFeeRate = mi->GetPackageFeeRate();
+                if (packageFeeRate > feeRate)
+                {
+                    feeRate = packageFeeRate;
+                }
+            }
+
             if (porphan)
             {
                 porphan->dPriority = dPriority;
@@ -3183,6 +3308,8 @@ CBlockTemplate* CreateNewBlock(const CChainParams& chainparams, const std::vecto
             }
         }
 
+        templateTxCache.EndPass();
+
         // remove transactions that we should from the mempool
         for (auto &oneTx : txesToRemove)
         {
@@ -3966,6 +4093,8 @@ void static VerusStaker(CWallet *pwallet)
 typedef bool (*minefunction)(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 bool mine_verus_v2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 bool mine_verus_v2_port(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+bool mine_verus_v2x2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+bool mine_verus_v2x4(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 
 void static BitcoinMiner_noeq(CWallet *pwallet)
 #else
@@ -4217,7 +4346,16 @@ void static BitcoinMiner_noeq()
             u128 *hashKey;
             verusclhasher &vclh = vh2->vclh;
             minefunction mine_verus;
-            mine_verus = IsCPUVerusOptimized() ? &mine_verus_v2 : &mine_verus_v2_port;
+            if (IsCPUVerusOptimized())
+            {
+                // hash several nonces per call with interleaved lanes, each on its own key copy
+                int nLanes = GetArg("-minerlanes", 1);
+                mine_verus = nLanes >= 4 ? &mine_verus_v2x4 : nLanes >= 2 ? &mine_verus_v2x2 : &mine_verus_v2;
+            }
+            else
+            {
+                mine_verus = &mine_verus_v2_port;
+            }
 
             while (true)
             {
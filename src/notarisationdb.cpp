@@ -10,7 +10,7 @@
 NotarisationDB *pnotarisations;
 
 
-NotarisationDB::NotarisationDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "notarisations", nCacheSize, fMemory, fWipe, false, 64) { }
+NotarisationDB::NotarisationDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "notarisations", nCacheSize, fMemory, fWipe, false, 64, "notarisations") { }
 
 
 NotarisationsInBlock ScanBlockNotarisations(const CBlock &block, int nHeight)
@@ -17,6 +17,7 @@
 
 #include "version.h"
 #include "uint256.h"
+#include "prevector.h"
 #include <univalue.h>
 #include <sstream>
 #include "streams.h"
@@ -375,11 +376,177 @@ public:
 
 extern int64_t AmountFromValueNoErr(const UniValue& value);
 
+// map of keys to values kept as a sorted array, inline for up to N entries, with the parts of the std::map interface
+// that currency maps use. currency maps almost always hold a few entries, so this avoids a heap allocation per entry
+// and pointer chasing on every lookup. unlike std::map, inserting or erasing invalidates iterators to other entries.
+// serializes exactly as the std::map it replaces.
+template <typename K, typename V, unsigned int N>
+class CSmallFlatMap
+{
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<K, V> value_type;
+    typedef prevector<N, value_type> storage_type;
+    typedef typename storage_type::iterator iterator;
+    typedef typename storage_type::const_iterator const_iterator;
+    typedef typename storage_type::size_type size_type;
+
+private:
+    storage_type entries;
+
+    size_type LowerBoundIndex(const K &key) const
+    {
+        size_type low = 0, high = entries.size();
+        while (low < high)
+        {
+            size_type mid = (low + high) >> 1;
+            if (entries[mid].first < key)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+public:
+    CSmallFlatMap() {}
+    CSmallFlatMap(const std::map<K, V> &sortedMap)
+    {
+        entries.reserve(sortedMap.size());
+        for (auto &oneEntry : sortedMap)
+        {
+            entries.push_back(oneEntry);
+        }
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+
+    size_type size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_type n) { entries.reserve(n); }
+
+    iterator lower_bound(const K &key) { return entries.begin() + LowerBoundIndex(key); }
+    const_iterator lower_bound(const K &key) const { return entries.begin() + LowerBoundIndex(key); }
+
+    iterator find(const K &key)
+    {
+        size_type index = LowerBoundIndex(key);
+        return (index < entries.size() && !(key < entries[index].first)) ? entries.begin() + index : entries.end();
+    }
+
+    const_iterator find(const K &key) const
+    {
+        size_type index = LowerBoundIndex(key);
+        return (index < entries.size() && !(key < entries[index].first)) ? entries.begin() + index : entries.end();
+    }
+
+    size_type count(const K &key) const
+    {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    V &operator[](const K &key)
+    {
+        size_type index = LowerBoundIndex(key);
+        if (index == entries.size() || key < entries[index].first)
+        {
+            entries.insert(entries.begin() + index, value_type(key, V()));
+        }
+        return entries[index].second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &entry)
+    {
+        size_type index = LowerBoundIndex(entry.first);
+        if (index < entries.size() && !(entry.first < entries[index].first))
+        {
+            return std::make_pair(entries.begin() + index, false);
+        }
+        return std::make_pair(entries.insert(entries.begin() + index, entry), true);
+    }
+
+    // like std::map, the hint only makes inserting in key order cheaper, so building from sorted input is linear
+    iterator insert(const_iterator hint, const value_type &entry)
+    {
+        size_type index = hint - entries.begin();
+        if ((index == entries.size() || entry.first < entries[index].first) &&
+            (index == 0 || entries[index - 1].first < entry.first))
+        {
+            return entries.insert(entries.begin() + index, entry);
+        }
+        return insert(entry).first;
+    }
+
+    iterator erase(iterator it)
+    {
+        return entries.erase(it);
+    }
+
+    size_type erase(const K &key)
+    {
+        iterator it = find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        entries.erase(it);
+        return 1;
+    }
+
+    friend bool operator==(const CSmallFlatMap &a, const CSmallFlatMap &b)
+    {
+        return a.entries == b.entries;
+    }
+
+    friend bool operator!=(const CSmallFlatMap &a, const CSmallFlatMap &b)
+    {
+        return !(a.entries == b.entries);
+    }
+
+    template <typename Stream>
+    void Serialize(Stream &s) const
+    {
+        WriteCompactSize(s, entries.size());
+        for (const value_type &oneEntry : entries)
+        {
+            ::Serialize(s, oneEntry);
+        }
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream &s)
+    {
+        entries.clear();
+        unsigned int nSize = ReadCompactSize(s);
+        for (unsigned int i = 0; i < nSize; i++)
+        {
+            value_type oneEntry;
+            ::Unserialize(s, oneEntry);
+            entries.push_back(oneEntry);
+        }
+
+        // sort once, and as with std::map, keep the first of any duplicate keys, which the stable sort leaves in front
+        std::stable_sort(entries.begin(), entries.end(), [](const value_type &a, const value_type &b) { return a.first < b.first; });
+        entries.erase(std::unique(entries.begin(), entries.end(), [](const value_type &a, const value_type &b) { return !(a.first < b.first) && !(b.first < a.first); }),
+                      entries.end());
+    }
+};
+
 // convenience class for collections of currencies that supports comparisons, including ==, >, >=, <, <=, as well as addition, and subtraction
 class CCurrencyValueMap
 {
 public:
-    std::map<uint160, int64_t> valueMap;
+    typedef CSmallFlatMap<uint160, int64_t, 4> value_map_type;
+    value_map_type valueMap;
 
     CCurrencyValueMap() {}
     CCurrencyValueMap(const CCurrencyValueMap &operand) : valueMap(operand.valueMap) {}
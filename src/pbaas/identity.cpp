@@ -148,10 +148,23 @@ bool CIdentity::IsInvalidMutation(const CIdentity &newIdentity, uint32_t height,
     return false;
 }
 
-CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height, uint32_t *pHeightOut, CTxIn *pIdTxIn, bool checkMempool)
+CIdentityCache IdentityCache;
+
+UniValue CIdentityCache::ToUniValue()
 {
-    LOCK(mempool.cs);
+    UniValue ret(UniValue::VOBJ);
+    uint64_t nHits = hits, nMisses = misses;
+    ret.pushKV("entries", cache.Size());
+    ret.pushKV("hits", nHits);
+    ret.pushKV("misses", nMisses);
+    ret.pushKV("hitrate", (nHits + nMisses) ? (double)nHits / (double)(nHits + nMisses) : 0.0);
+    ret.pushKV("invalidations", (uint64_t)invalidations);
+    ret.pushKV("staleputs", (uint64_t)stalePuts);
+    return ret;
+}
 
+CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height, uint32_t *pHeightOut, CTxIn *pIdTxIn, bool checkMempool)
+{
     CIdentity ret;
 
     uint32_t heightOut = 0;
@@ -179,6 +192,8 @@ CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height,
 
     if ((!height || height > chainActive.Height()) && checkMempool)
     {
+        // only the mempool check needs a consistent view of the mempool, confirmed lookups don't take its lock
+        LOCK(mempool.cs);
         ConnectedChains.GetUnspentByIndex(keyID, unspentInputs);
         // if we got it from the mempool, don't check view
         if (unspentInputs.size() && !unspentInputs[0].second)
@@ -205,8 +220,39 @@ CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height,
         unspentInputs.clear();
     }
 
-    if (unspentOutputs.size() || GetAddressUnspent(keyID, CScript::P2IDX, unspentNewIDX) && GetAddressUnspent(keyID, CScript::P2PKH, unspentOutputs))
+    CIdentityCache::CIdentityCacheKey cacheKey(nameID, height);
+    CIdentityCache::CIdentityCacheValue cacheValue;
+    uint64_t cacheGeneration = IdentityCache.Generation();
+    if (IdentityCache.Get(cacheKey, cacheValue))
+    {
+        idTxIn = std::get<2>(cacheValue);
+        *pHeightOut = std::get<1>(cacheValue);
+        return std::get<0>(cacheValue);
+    }
+
+    CIdentityUnspentIndexValue identityIndexValue;
+    bool haveLatest = false;
+
+    if (fIdentityUnspentIndex)
     {
+        // the identity unspent index holds the latest confirmed state of every identity
+        haveLatest = true;
+        if (GetIdentityUnspent(nameID, identityIndexValue) &&
+            (ret = CIdentity(identityIndexValue.identity)).IsValid() &&
+            ret.GetID() == nameID)
+        {
+            idTxIn = CTxIn(identityIndexValue.txhash, identityIndexValue.index);
+            *pHeightOut = identityIndexValue.blockHeight;
+        }
+        else
+        {
+            ret = CIdentity();
+        }
+    }
+    else if (GetAddressUnspent(keyID, CScript::P2IDX, unspentNewIDX) && GetAddressUnspent(keyID, CScript::P2PKH, unspentOutputs))
+    {
+        haveLatest = true;
+
         // combine searches into 1 vector
         unspentOutputs.insert(unspentOutputs.begin(), unspentNewIDX.begin(), unspentNewIDX.end());
         CCoinsViewCache view(pcoinsTip);
@@ -243,7 +289,10 @@ CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height,
                 }
             }
         }
+    }
 
+    if (haveLatest)
+    {
         if (height != 0 && (*pHeightOut > height || (height == 1 && *pHeightOut == height)))
         {
             *pHeightOut = 0;
@@ -293,6 +342,7 @@ CIdentity CIdentity::LookupIdentity(const CIdentityID &nameID, uint32_t height,
                 idTxIn = CTxIn();
             }
         }
+        IdentityCache.Put(cacheKey, CIdentityCache::CIdentityCacheValue(ret, *pHeightOut, idTxIn), cacheGeneration);
     }
     return ret;
 }
@@ -32,6 +32,10 @@
 #include "primitives/transaction.h"
 #include "arith_uint256.h"
 #include "addressindex.h"
+#include "lrucache.h"
+#include "sync.h"
+
+#include <atomic>
 
 std::string CleanName(const std::string &Name, uint160 &Parent, bool displayapproved=false, bool addVerus=true);
 
@@ -1268,6 +1272,73 @@ public:
     UniValue ToUniValue() const;
 };
 
+// caches confirmed results of CIdentity::LookupIdentity by identity ID and lookup height, so repeated lookups of the
+// same identities while validating a block or serving RPC calls do not go back to the indexes and coins view.
+// ConnectBlock, DisconnectBlock and UpdateTip clear it under cs_main as soon as the indexes or the tip change. each
+// clear starts a new generation, and a lookup only stores its result if no clear happened since it read the indexes.
+class CIdentityCache
+{
+public:
+    typedef std::pair<uint160, uint32_t> CIdentityCacheKey;
+    typedef std::tuple<CIdentity, uint32_t, CTxIn> CIdentityCacheValue;
+
+    static const int DEFAULT_IDENTITY_CACHE_SIZE = 2000;
+
+    CIdentityCache(int capacity=DEFAULT_IDENTITY_CACHE_SIZE) :
+        cache(capacity, 0.1F, true), generation(0), hits(0), misses(0), invalidations(0), stalePuts(0) {}
+
+    // must be read before a lookup reads the indexes and passed to Put with its result
+    uint64_t Generation() const
+    {
+        return generation;
+    }
+
+    bool Get(const CIdentityCacheKey &key, CIdentityCacheValue &value)
+    {
+        if (cache.Get(key, value))
+        {
+            hits++;
+            return true;
+        }
+        misses++;
+        return false;
+    }
+
+    // returns false and drops the value if the cache was cleared after lookupGeneration was read
+    bool Put(const CIdentityCacheKey &key, const CIdentityCacheValue &value, uint64_t lookupGeneration)
+    {
+        LOCK(cs);
+        if (lookupGeneration != generation)
+        {
+            stalePuts++;
+            return false;
+        }
+        cache.Put(key, value);
+        return true;
+    }
+
+    void Clear()
+    {
+        LOCK(cs);
+        generation++;
+        cache.Clear();
+        invalidations++;
+    }
+
+    UniValue ToUniValue();
+
+private:
+    CCriticalSection cs;                // orders Clear against Put, so no result from an older generation is stored
+    LRUCache<CIdentityCacheKey, CIdentityCacheValue> cache;
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> invalidations;
+    std::atomic<uint64_t> stalePuts;
+};
+
+extern CIdentityCache IdentityCache;
+
 struct CCcontract_info;
 struct Eval;
 class CValidationState;
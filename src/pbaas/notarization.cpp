@@ -17,6 +17,7 @@
 #include "rpc/pbaasrpc.h"
 #include "transaction_builder.h"
 #include "cc/StakeGuard.h"
+#include "script/decodecache.h"
 
 #include <timedata.h>
 #include <assert.h>
@@ -761,6 +762,10 @@ CPBaaSNotarization::CPBaaSNotarization(const CScript &scriptPubKey) :
                     notarizationHeight(0),
                     prevHeight(0)
 {
+    if (CBlockScriptCache::GetObject(scriptPubKey, *this))
+    {
+        return;
+    }
     COptCCParams p;
     if (scriptPubKey.IsPayToCryptoCondition(p) &&
         p.IsValid() &&
@@ -769,6 +774,7 @@ CPBaaSNotarization::CPBaaSNotarization(const CScript &scriptPubKey) :
     {
         ::FromVector(p.vData[0], *this);
     }
+    CBlockScriptCache::PutObject(scriptPubKey, *this);
 }
 
 CPBaaSNotarization::CPBaaSNotarization(const CTransaction &tx, int32_t *pOutIdx) :
@@ -5849,24 +5849,39 @@ bool CConnectedChains::GetUnspentByIndex(const uint160 &indexID, std::vector<std
 
     for (auto &oneConfirmed : confirmedUTXOs)
     {
-        BlockMap::iterator blockIt;
-        std::pair<CTransaction, uint256> txAndBlkHash;
-        bool fromCache = false;
-        bool fromChain = false;
-        if (spentInMempool.count(COutPoint(oneConfirmed.first.txhash, oneConfirmed.first.index)) ||
-            (!(fromCache = txesBeingSpent.Get(oneConfirmed.first.txhash, txAndBlkHash)) &&
-             !(fromChain = myGetTransaction(oneConfirmed.first.txhash, txAndBlkHash.first, txAndBlkHash.second))) ||
-            (blockIt = mapBlockIndex.find(txAndBlkHash.second)) == mapBlockIndex.end() ||
-            !chainActive.Contains(blockIt->second))
+        if (spentInMempool.count(COutPoint(oneConfirmed.first.txhash, oneConfirmed.first.index)))
         {
-            if (fromChain)
+            continue;
+        }
+
+        // an entry that records its confirming block needs no transaction lookup as long as that block is
+        // still on the active chain. entries written before the block was recorded, or left behind by a
+        // crash or reorg, fall back to reading the transaction.
+        CBlockIndex *pConfirmedIndex = oneConfirmed.second.confirmedHeight >= 0 ? chainActive[oneConfirmed.second.confirmedHeight] : NULL;
+        if (pConfirmedIndex && pConfirmedIndex->GetBlockHash() == oneConfirmed.second.confirmedBlockHash)
+        {
+            oneConfirmed.second.blockHeight = oneConfirmed.second.confirmedHeight;
+        }
+        else
+        {
+            BlockMap::iterator blockIt;
+            std::pair<CTransaction, uint256> txAndBlkHash;
+            bool fromCache = false;
+            bool fromChain = false;
+            if ((!(fromCache = txesBeingSpent.Get(oneConfirmed.first.txhash, txAndBlkHash)) &&
+                 !(fromChain = myGetTransaction(oneConfirmed.first.txhash, txAndBlkHash.first, txAndBlkHash.second))) ||
+                (blockIt = mapBlockIndex.find(txAndBlkHash.second)) == mapBlockIndex.end() ||
+                !chainActive.Contains(blockIt->second))
             {
-                txesBeingSpent.Put(oneConfirmed.first.txhash, txAndBlkHash);
+                if (fromChain)
+                {
+                    txesBeingSpent.Put(oneConfirmed.first.txhash, txAndBlkHash);
+                }
+                continue;
             }
-            continue;
+            txesBeingSpent.Put(oneConfirmed.first.txhash, txAndBlkHash);
+            oneConfirmed.second.blockHeight = blockIt->second->GetHeight();
         }
-        txesBeingSpent.Put(oneConfirmed.first.txhash, txAndBlkHash);
-        oneConfirmed.second.blockHeight = blockIt->second->GetHeight();
 
         COptCCParams p;
         if (!mempool.mapNextTx.count(COutPoint(oneConfirmed.first.txhash, oneConfirmed.first.index)) &&
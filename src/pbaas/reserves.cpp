@@ -1778,8 +1778,6 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
                                                     std::vector<std::vector<CAmount>> const *pCrossConversions,
                                                     std::vector<CAmount> *pViaPrices) const
 {
-    static arith_uint256 bigSatoshi(SATOSHIDEN);
-
     int32_t numCurrencies = currencies.size();
     std::vector<CAmount> inputReserves = _inputReserves;
     std::vector<CAmount> inputFractional = _inputFractional;
@@ -1903,8 +1901,6 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
     // aggregate amounts of ins and outs across all currencies expressed in fractional values in both directions first buy/sell, then sell/buy
     std::map<uint160, std::pair<CAmount, CAmount>> fractionalInMap, fractionalOutMap;
 
-    arith_uint256 bigSupply(supply);
-
     int32_t totalReserveWeight = 0;
     int32_t maxReserveRatio = 0;
 
@@ -1926,21 +1922,17 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
     }
 
     // it is currently an error to have > 100% reserve ratio currency
-    if (totalReserveWeight > bigSatoshi)
+    if ((uint64_t)totalReserveWeight > SATOSHIDEN)
     {
         LogPrintf("%s: total currency backing weight exceeds 100%\n", __func__);
         return initialRates;
     }
 
-    arith_uint256 bigMaxReserveRatio = arith_uint256(maxReserveRatio);
-    arith_uint256 bigTotalReserveWeight = arith_uint256(totalReserveWeight);
-
     // reduce each currency change to a net inflow or outflow of fractional currency and
     // store both negative and positive in structures sorted by the net amount, adjusted
     // by the difference of the ratio between the weights of each currency
     for (int64_t i = 0; i < numCurrencies; i++)
     {
-        arith_uint256 weight(weights[i]);
         //printf("%s: %ld\n", __func__, ReserveToNative(inputReserves[i], i));
         CAmount asNative = ReserveToNative(inputReserves[i], i);
         // if overflow
@@ -1951,28 +1943,28 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         }
         CAmount netFractional = inputFractional[i] - asNative;
         int64_t deltaRatio;
-        arith_uint256 bigDeltaRatio;
+        unsigned __int128 bigDeltaRatio;
         if (netFractional > 0)
         {
-            bigDeltaRatio = ((arith_uint256(netFractional) * bigMaxReserveRatio) / weight);
+            bigDeltaRatio = MultiplyDivide(netFractional, maxReserveRatio, weights[i]);
             if (bigDeltaRatio > INT64_MAX)
             {
                 failed = true;
                 break;
             }
-            deltaRatio = bigDeltaRatio.GetLow64();
+            deltaRatio = (uint64_t)bigDeltaRatio;
             fractionalIn.insert(std::make_pair(deltaRatio, std::make_pair(netFractional, currencies[i])));
         }
         else if (netFractional < 0)
         {
             netFractional = -netFractional;
-            bigDeltaRatio = ((arith_uint256(netFractional) * bigMaxReserveRatio) / weight);
+            bigDeltaRatio = MultiplyDivide(netFractional, maxReserveRatio, weights[i]);
             if (bigDeltaRatio > INT64_MAX)
             {
                 failed = true;
                 break;
             }
-            deltaRatio = bigDeltaRatio.GetLow64();
+            deltaRatio = (uint64_t)bigDeltaRatio;
             fractionalOut.insert(std::make_pair(deltaRatio, std::make_pair(netFractional, currencies[i])));
         }
     }
@@ -2007,7 +1999,7 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         {
             // reverse the calculation from layer height to amount for this currency, based on currency weight
             int32_t weight = weights[reserveMap[it->second.second]];
-            CAmount curAmt = ((arith_uint256(layerHeight) * arith_uint256(weight) / bigMaxReserveRatio)).GetLow64();
+            CAmount curAmt = (uint64_t)MultiplyDivide(layerHeight, weight, maxReserveRatio);
             it->second.first -= curAmt;
 
             if (it->second.first < 0)
@@ -2033,13 +2025,13 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         for (auto it = outFIT; it != fractionalOut.end(); it++)
         {
             int32_t weight = weights[reserveMap[it->second.second]];
-            arith_uint256 bigCurAmt = ((arith_uint256(layerHeight) * arith_uint256(weight) / bigMaxReserveRatio));
+            unsigned __int128 bigCurAmt = MultiplyDivide(layerHeight, weight, maxReserveRatio);
             if (bigCurAmt > INT64_MAX)
             {
                 LogPrintf("%s: OVERFLOW in calculating changes in currency\n", __func__);
                 return initialRates;
             }
-            CAmount curAmt = bigCurAmt.GetLow64();
+            CAmount curAmt = (uint64_t)bigCurAmt;
             it->second.first -= curAmt;
             assert(it->second.first >= 0);
 
@@ -2063,8 +2055,7 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         //
         // calculate a fractional buy at the total layer ratio for the amount specified
         // and divide the value according to the relative weight of each currency, adding to each entry of fractionalOutMap
-        arith_uint256 bigLayerWeight = arith_uint256(layer.first);
-        CAmount totalLayerReserves = ((bigSupply * bigLayerWeight) / bigSatoshi).GetLow64() + addNormalizedReserves;
+        CAmount totalLayerReserves = (uint64_t)MultiplyDivide(supply, layer.first, SATOSHIDEN) + addNormalizedReserves;
         addNormalizedReserves += layer.second.first;
         CAmount newSupply = CalculateFractionalOut(layer.second.first, supply + addSupply, totalLayerReserves, layer.first);
         if (newSupply < 0)
@@ -2072,12 +2063,13 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
             LogPrintf("%s: currency supply OVERFLOW\n", __func__);
             return initialRates;
         }
-        arith_uint256 bigNewSupply(newSupply);
         addSupply += newSupply;
         for (auto &id : layer.second.second)
         {
             auto idIT = fractionalOutMap.find(id);
-            CAmount newSupplyForCurrency = ((bigNewSupply * weights[reserveMap[id]]) / bigLayerWeight).GetLow64();
+
+            // the weight is taken as uint32_t here, as it was by arith_uint256
+            CAmount newSupplyForCurrency = (uint64_t)MultiplyDivide(newSupply, (uint32_t)weights[reserveMap[id]], layer.first);
 
             // initialize or add to the new supply for this currency
             if (idIT == fractionalOutMap.end())
@@ -2105,11 +2097,10 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
     for (auto &layer : fractionalLayersIn)
     {
         // first calculate sell before-buy, then after-buy
-        arith_uint256 bigLayerWeight(layer.first);
 
         // before-buy starting point
-        CAmount totalLayerReservesBB = ((bigSupply * bigLayerWeight) / bigSatoshi).GetLow64() + addNormalizedReservesBB;
-        CAmount totalLayerReservesAB = ((arith_uint256(supplyAfterBuy) * bigLayerWeight) / bigSatoshi).GetLow64() + addNormalizedReservesAB;
+        CAmount totalLayerReservesBB = (uint64_t)MultiplyDivide(supply, layer.first, SATOSHIDEN) + addNormalizedReservesBB;
+        CAmount totalLayerReservesAB = (uint64_t)MultiplyDivide(supplyAfterBuy, layer.first, SATOSHIDEN) + addNormalizedReservesAB;
 
         CAmount newNormalizedReserveBB = CalculateReserveOut(layer.second.first, supply + addSupply, totalLayerReservesBB + addNormalizedReservesBB, layer.first);
         CAmount newNormalizedReserveAB = CalculateReserveOut(layer.second.first, supplyAfterBuy + addSupply, totalLayerReservesAB + addNormalizedReservesAB, layer.first);
@@ -2122,8 +2113,8 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         for (auto &id : layer.second.second)
         {
             auto idIT = fractionalInMap.find(id);
-            CAmount newReservesForCurrencyBB = ((arith_uint256(newNormalizedReserveBB) * arith_uint256(weights[reserveMap[id]])) / bigLayerWeight).GetLow64();
-            CAmount newReservesForCurrencyAB = ((arith_uint256(newNormalizedReserveAB) * arith_uint256(weights[reserveMap[id]])) / bigLayerWeight).GetLow64();
+            CAmount newReservesForCurrencyBB = (uint64_t)MultiplyDivide(newNormalizedReserveBB, weights[reserveMap[id]], layer.first);
+            CAmount newReservesForCurrencyAB = (uint64_t)MultiplyDivide(newNormalizedReserveAB, weights[reserveMap[id]], layer.first);
 
             // initialize or add to the new supply for this currency
             if (idIT == fractionalInMap.end())
@@ -2156,11 +2147,9 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
     // now calculate buy after sell
     for (auto &layer : fractionalLayersOut)
     {
-        arith_uint256 bigLayerWeight = arith_uint256(layer.first);
-        CAmount totalLayerReserves = ((arith_uint256(supplyAfterSell) * bigLayerWeight) / bigSatoshi).GetLow64() + addNormalizedReserves;
+        CAmount totalLayerReserves = (uint64_t)MultiplyDivide(supplyAfterSell, layer.first, SATOSHIDEN) + addNormalizedReserves;
         addNormalizedReserves += layer.second.first;
         CAmount newSupply = CalculateFractionalOut(layer.second.first, supplyAfterSell + addSupply, totalLayerReserves, layer.first);
-        arith_uint256 bigNewSupply(newSupply);
         addSupply += newSupply;
         for (auto &id : layer.second.second)
         {
@@ -2168,7 +2157,7 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
 
             assert(idIT != fractionalOutMap.end());
 
-            idIT->second.second += ((bigNewSupply * weights[reserveMap[id]]) / bigLayerWeight).GetLow64();
+            idIT->second.second += (uint64_t)MultiplyDivide(newSupply, (uint32_t)weights[reserveMap[id]], layer.first);
         }
     }
 
@@ -2195,12 +2184,11 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
 
         if (fractionalOutIT != fractionalOutMap.end())
         {
-            arith_uint256 bigFractionDelta(fractionalOutIT->second.first);
-            fractionDelta = ((bigFractionDelta + arith_uint256(fractionalOutIT->second.second)) >> 1).GetLow64();
+            fractionDelta = (uint64_t)(((unsigned __int128)(uint64_t)fractionalOutIT->second.first + (uint64_t)fractionalOutIT->second.second) >> 1);
             assert(inputFraction + fractionDelta > 0);
 
             fractionalSizes[i] += fractionDelta;
-            rates[i] = ((arith_uint256(inputReserve) * bigSatoshi) / arith_uint256(fractionalSizes[i])).GetLow64();
+            rates[i] = (uint64_t)MultiplyDivide(inputReserve, SATOSHIDEN, fractionalSizes[i]);
 
             // add the new reserve and supply to the currency
             newState.supply += fractionDelta;
@@ -2210,12 +2198,11 @@ std::vector<CAmount> CCurrencyState::ConvertAmounts(const std::vector<CAmount> &
         }
         else if (fractionalInIT != fractionalInMap.end())
         {
-            arith_uint256 bigReserveDelta(fractionalInIT->second.first);
-            CAmount adjustedReserveDelta = NativeToReserve(((bigReserveDelta + arith_uint256(fractionalInIT->second.second)) >> 1).GetLow64(), i);
+            CAmount adjustedReserveDelta = NativeToReserve((uint64_t)(((unsigned __int128)(uint64_t)fractionalInIT->second.first + (uint64_t)fractionalInIT->second.second) >> 1), i);
             reserveSizes[i] += adjustedReserveDelta;
             assert(inputFraction > 0);
 
-            rates[i] = ((arith_uint256(reserveSizes[i]) * bigSatoshi) / arith_uint256(inputFraction)).GetLow64();
+            rates[i] = (uint64_t)MultiplyDivide(reserveSizes[i], SATOSHIDEN, inputFraction);
 
             // subtract the fractional and reserve that has left the currency
             newState.supply -= inputFraction;
@@ -6259,24 +6246,19 @@ void CCoinbaseCurrencyState::RevertReservesAndSupply(const uint160 &systemID, bo
 
 CAmount CCurrencyState::CalculateConversionFee(CAmount inputAmount, bool convertToNative, int currencyIndex) const
 {
-    arith_uint256 bigAmount(inputAmount);
-    arith_uint256 bigSatoshi(SATOSHIDEN);
+    unsigned __int128 bigAmount = (uint64_t)inputAmount;
 
     // we need to calculate a fee based either on the amount to convert or the last price
     // times the reserve
     if (convertToNative)
     {
-        int64_t price;
-        cpp_dec_float_50 priceInReserve = PriceInReserveDecFloat50(currencyIndex);
-        if (!to_int64(priceInReserve, price))
-        {
-            assert(false);
-        }
-        bigAmount = price ? (bigAmount * bigSatoshi) / arith_uint256(price) : 0;
+        int64_t price = PriceInReserveTruncated(currencyIndex);
+        bigAmount = price ? MultiplyDivide(inputAmount, SATOSHIDEN, price) : 0;
     }
 
+    // bigAmount is below 2^91, so this cannot overflow
     CAmount fee = 0;
-    fee = ((bigAmount * arith_uint256(CReserveTransfer::SUCCESS_FEE)) / bigSatoshi).GetLow64();
+    fee = (uint64_t)((bigAmount * CReserveTransfer::SUCCESS_FEE) / SATOSHIDEN);
     if (fee < CReserveTransfer::MIN_SUCCESS_FEE)
     {
         fee = CReserveTransfer::MIN_SUCCESS_FEE;
@@ -6286,9 +6268,7 @@ CAmount CCurrencyState::CalculateConversionFee(CAmount inputAmount, bool convert
 
 CAmount CReserveTransactionDescriptor::CalculateConversionFeeNoMin(CAmount inputAmount)
 {
-    arith_uint256 bigAmount(inputAmount);
-    arith_uint256 bigSatoshi(SATOSHIDEN);
-    return ((bigAmount * arith_uint256(CReserveTransfer::SUCCESS_FEE)) / bigSatoshi).GetLow64();
+    return (uint64_t)CCurrencyState::MultiplyDivide(inputAmount, CReserveTransfer::SUCCESS_FEE, SATOSHIDEN);
 }
 
 CAmount CReserveTransactionDescriptor::CalculateConversionFee(CAmount inputAmount)
@@ -6306,11 +6286,7 @@ CAmount CReserveTransactionDescriptor::CalculateConversionFee(CAmount inputAmoun
 // the same amount
 CAmount CReserveTransactionDescriptor::CalculateAdditionalConversionFee(CAmount inputAmount)
 {
-    arith_uint256 bigAmount(inputAmount);
-    arith_uint256 bigSatoshi(SATOSHIDEN);
-    arith_uint256 conversionFee(CReserveTransfer::SUCCESS_FEE);
-
-    CAmount newAmount = ((bigAmount * bigSatoshi) / (bigSatoshi - conversionFee)).GetLow64();
+    CAmount newAmount = (uint64_t)CCurrencyState::MultiplyDivide(inputAmount, SATOSHIDEN, SATOSHIDEN - CReserveTransfer::SUCCESS_FEE);
     if (newAmount - inputAmount < CReserveTransfer::MIN_SUCCESS_FEE)
     {
         newAmount = inputAmount + CReserveTransfer::MIN_SUCCESS_FEE;
@@ -1321,6 +1321,16 @@ public:
         }
     }
 
+    // exact (a * b) / c on an unsigned 128 bit intermediate, which holds the product of any two 64 bit values. operands are
+    // taken as unsigned 64 bit values, as arith_uint256 takes them, so the quotient, or its low 64 bits, is identical to that
+    // of the arith_uint256 expression it replaces in conversion math, without the cost of 256 bit long division. an
+    // arith_uint256 multiplied directly by an integer took it as uint32_t, so callers replacing such a product cast b to
+    // uint32_t. c must not be 0.
+    static unsigned __int128 MultiplyDivide(uint64_t a, uint64_t b, uint64_t c)
+    {
+        return ((unsigned __int128)a * b) / c;
+    }
+
     // in a fractional reserve with no reserve or supply, this will always return
     // a price of the reciprocal (1/x) of the fractional reserve ratio of the indexed reserve,
     // which will always be >= 1
@@ -1329,6 +1339,10 @@ public:
     // return the current price of the fractional reserve in the reserve currency in Satoshis
     cpp_dec_float_50 PriceInReserveDecFloat50(int32_t reserveIndex=0) const;
 
+    // the price of PriceInReserveDecFloat50 as converted by to_int64, truncated toward zero and limited to the int64_t range,
+    // calculated exactly in 128 bit integer math
+    CAmount PriceInReserveTruncated(int32_t reserveIndex=0) const;
+
     std::vector<CAmount> PricesInReserve(bool roundUp=false) const;
 
     // This considers one currency at a time
@@ -477,6 +477,12 @@ UniValue mempoolToJSON(bool fVerbose = false)
             info.push_back(Pair("height", (int)e.GetHeight()));
             info.push_back(Pair("startingpriority", e.GetPriority(e.GetHeight())));
             info.push_back(Pair("currentpriority", e.GetPriority(chainActive.Height())));
+            info.push_back(Pair("descendantcount", e.GetCountWithDescendants()));
+            info.push_back(Pair("descendantsize", e.GetSizeWithDescendants()));
+            info.push_back(Pair("descendantfees", ValueFromAmount(e.GetModFeesWithDescendants())));
+            info.push_back(Pair("ancestorcount", e.GetCountWithAncestors()));
+            info.push_back(Pair("ancestorsize", e.GetSizeWithAncestors()));
+            info.push_back(Pair("ancestorfees", ValueFromAmount(e.GetModFeesWithAncestors())));
             const CTransaction& tx = e.GetTx();
             set<string> setDepends;
             BOOST_FOREACH(const CTxIn& txin, tx.vin)
@@ -531,6 +537,12 @@ UniValue getrawmempool(const UniValue& params, bool fHelp)
             "    \"height\" : n,           (numeric) block height when transaction entered pool\n"
             "    \"startingpriority\" : n, (numeric) priority when transaction entered pool\n"
             "    \"currentpriority\" : n,  (numeric) transaction priority now\n"
+            "    \"descendantcount\" : n,  (numeric) number of in-mempool descendant transactions (including this one)\n"
+            "    \"descendantsize\" : n,   (numeric) size of in-mempool descendants (including this one)\n"
+            "    \"descendantfees\" : n,   (numeric) modified fees of in-mempool descendants (including this one)\n"
+            "    \"ancestorcount\" : n,    (numeric) number of in-mempool ancestor transactions (including this one)\n"
+            "    \"ancestorsize\" : n,     (numeric) size of in-mempool ancestors (including this one)\n"
+            "    \"ancestorfees\" : n,     (numeric) modified fees of in-mempool ancestors (including this one)\n"
             "    \"depends\" : [           (array) unconfirmed transactions used as inputs for this transaction\n"
             "        \"transactionid\",    (string) parent transaction id\n"
             "       ... ]\n"
@@ -1140,11 +1152,17 @@ UniValue getblock(const UniValue& params, bool fHelp)
 
 UniValue gettxoutsetinfo(const UniValue& params, bool fHelp)
 {
-    if (fHelp || params.size() != 0)
+    if (fHelp || params.size() > 2)
         throw runtime_error(
-            "gettxoutsetinfo\n"
+            "gettxoutsetinfo ( \"hash_type\" height )\n"
             "\nReturns statistics about the unspent transaction output set.\n"
-            "Note this call may take some time.\n"
+            "With hash_type \"hash_serialized\", the default, the whole set is scanned, which may take some time.\n"
+            "With \"muhash\", which requires -utxostatsindex, the statistics are kept as each block is connected and are\n"
+            "returned at once, also for past heights.\n"
+            "\nArguments:\n"
+            "1. \"hash_type\"   (string, optional, default=\"hash_serialized\") \"hash_serialized\" or \"muhash\"\n"
+            "2. height        (numeric, optional, default=current height) with \"muhash\", the height to return the statistics at.\n"
+            "                 Heights before -utxostatsindex was turned on are computed from the undo data of the blocks between\n"
             "\nResult:\n"
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
@@ -1155,23 +1173,114 @@ UniValue gettxoutsetinfo(const UniValue& params, bool fHelp)
             "  \"hash_serialized\": \"hash\",   (string) The serialized hash\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
             "}\n"
+            "\nResult with hash_type \"muhash\":\n"
+            "{\n"
+            "  \"height\":n,     (numeric) The block height of the statistics\n"
+            "  \"bestblock\": \"hex\",   (string) the hash of the block at that height\n"
+            "  \"txouts\": n,            (numeric) The number of unspent transaction outputs\n"
+            "  \"bogosize\": n,          (numeric) An estimate of the set's size, from a fixed overhead and the script of each output\n"
+            "  \"muhash\": \"hash\",       (string) The rolling hash of the set of outpoints and their outputs\n"
+            "  \"total_amount\": x.xxx   (numeric) The total amount\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("gettxoutsetinfo", "")
-            + HelpExampleRpc("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"muhash\" 1000")
+            + HelpExampleRpc("gettxoutsetinfo", "\"muhash\", 1000")
         );
 
+    std::string hashType = params.size() > 0 ? params[0].get_str() : "hash_serialized";
+    if (hashType != "hash_serialized" && hashType != "muhash")
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "hash_type must be \"hash_serialized\" or \"muhash\"");
+
     UniValue ret(UniValue::VOBJ);
 
-    CCoinsStats stats;
-    FlushStateToDisk();
-    if (pcoinsTip->GetStats(stats)) {
-        ret.push_back(Pair("height", (int64_t)stats.nHeight));
-        ret.push_back(Pair("bestblock", stats.hashBlock.GetHex()));
-        ret.push_back(Pair("transactions", (int64_t)stats.nTransactions));
-        ret.push_back(Pair("txouts", (int64_t)stats.nTransactionOutputs));
-        ret.push_back(Pair("bytes_serialized", (int64_t)stats.nSerializedSize));
-        ret.push_back(Pair("hash_serialized", stats.hashSerialized.GetHex()));
-        ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+    if (hashType == "hash_serialized")
+    {
+        if (params.size() > 1)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "height is only supported with hash_type \"muhash\"");
+
+        CCoinsStats stats;
+        FlushStateToDisk();
+        if (pcoinsTip->GetStats(stats)) {
+            ret.push_back(Pair("height", (int64_t)stats.nHeight));
+            ret.push_back(Pair("bestblock", stats.hashBlock.GetHex()));
+            ret.push_back(Pair("transactions", (int64_t)stats.nTransactions));
+            ret.push_back(Pair("txouts", (int64_t)stats.nTransactionOutputs));
+            ret.push_back(Pair("bytes_serialized", (int64_t)stats.nSerializedSize));
+            ret.push_back(Pair("hash_serialized", stats.hashSerialized.GetHex()));
+            ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+        }
+        return ret;
+    }
+
+    if (!fUTXOStatsIndex)
+        throw JSONRPCError(RPC_MISC_ERROR, "hash_type \"muhash\" requires -utxostatsindex");
+
+    const CBlockIndex *pindex;
+    {
+        LOCK(cs_main);
+        int nHeight = params.size() > 1 ? params[1].get_int() : chainActive.Height();
+        if (nHeight < 0 || nHeight > chainActive.Height())
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+
+        pindex = chainActive[nHeight];
+    }
+
+    // may roll back from the nearest indexed block above, which reads blocks from disk, so is done without cs_main
+    CUTXOStatsIndexValue utxoStats;
+    std::string strError;
+    if (!GetUTXOStats(pindex, utxoStats, strError))
+        throw JSONRPCError(RPC_DATABASE_ERROR, strError);
+
+    uint256 muhash;
+    utxoStats.muhash.Finalize(muhash);
+
+    ret.push_back(Pair("height", (int64_t)pindex->GetHeight()));
+    ret.push_back(Pair("bestblock", pindex->GetBlockHash().GetHex()));
+    ret.push_back(Pair("txouts", (int64_t)utxoStats.nTransactionOutputs));
+    ret.push_back(Pair("bogosize", (int64_t)utxoStats.nBogoSize));
+    ret.push_back(Pair("muhash", muhash.GetHex()));
+    ret.push_back(Pair("total_amount", ValueFromAmount(utxoStats.nTotalAmount)));
+    return ret;
+}
+
+UniValue getdbinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getdbinfo\n"
+            "\nReturns the option profile, cache sizes and block cache hit rate of each LevelDB database.\n"
+            "The address, spent and timestamp indexes are stored in, and reported as part of, the blockindex database.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"name\": \"name\",          (string) database name, as used with -dbprofile and -dbopt\n"
+            "    \"profile\": \"profile\",    (string) option profile the database was opened with\n"
+            "    \"blockcachesize\": n,      (numeric) block cache size in bytes\n"
+            "    \"writebuffersize\": n,     (numeric) write buffer size in bytes, up to two may be in use\n"
+            "    \"cachehits\": n,           (numeric) block cache lookups that hit since startup\n"
+            "    \"cachemisses\": n,         (numeric) block cache lookups that missed since startup\n"
+            "    \"hitrate\": x.xxx          (numeric) cachehits / (cachehits + cachemisses)\n"
+            "  },...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdbinfo", "")
+            + HelpExampleRpc("getdbinfo", "")
+        );
+
+    UniValue ret(UniValue::VARR);
+    BOOST_FOREACH(const CDBWrapperStats &stats, GetAllDBWrapperStats())
+    {
+        UniValue dbInfo(UniValue::VOBJ);
+        uint64_t lookups = stats.cacheHits + stats.cacheMisses;
+        dbInfo.push_back(Pair("name", stats.name));
+        dbInfo.push_back(Pair("profile", stats.profile));
+        dbInfo.push_back(Pair("blockcachesize", (int64_t)stats.blockCacheSize));
+        dbInfo.push_back(Pair("writebuffersize", (int64_t)stats.writeBufferSize));
+        dbInfo.push_back(Pair("cachehits", (int64_t)stats.cacheHits));
+        dbInfo.push_back(Pair("cachemisses", (int64_t)stats.cacheMisses));
+        dbInfo.push_back(Pair("hitrate", lookups ? (double)stats.cacheHits / lookups : 0.0));
+        ret.push_back(dbInfo);
     }
     return ret;
 }
@@ -1877,6 +1986,8 @@ UniValue mempoolInfoToJSON()
     ret.push_back(Pair("size", (int64_t) mempool.size()));
     ret.push_back(Pair("bytes", (int64_t) mempool.GetTotalTxSize()));
     ret.push_back(Pair("usage", (int64_t) mempool.DynamicMemoryUsage()));
+    ret.push_back(Pair("maxmempool", (int64_t) GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000));
+    ret.push_back(Pair("evicted", (int64_t) mempool.GetEvictedCount()));
 
     if (Params().NetworkIDString() == "regtest") {
         ret.push_back(Pair("fullyNotified", mempool.IsFullyNotified()));
@@ -1896,6 +2007,8 @@ UniValue getmempoolinfo(const UniValue& params, bool fHelp)
             "  \"size\": xxxxx                (numeric) Current tx count\n"
             "  \"bytes\": xxxxx               (numeric) Sum of all tx sizes\n"
             "  \"usage\": xxxxx               (numeric) Total memory usage for the mempool\n"
+            "  \"maxmempool\": xxxxx          (numeric) Maximum memory usage for the mempool\n"
+            "  \"evicted\": xxxxx             (numeric) Transactions evicted to stay under maxmempool since startup\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getmempoolinfo", "")
@@ -1999,6 +2112,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getrawmempool",          &getrawmempool,          true  },
     { "blockchain",         "gettxout",               &gettxout,               true  },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true  },
+    { "blockchain",         "getdbinfo",              &getdbinfo,              true  },
     { "blockchain",         "verifychain",            &verifychain,            true  },
 
     // insightexplorer
@@ -1670,6 +1670,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "fundrawtransaction", 1 },
     { "gettxout", 1 },
     { "gettxout", 2 },
+    { "gettxoutsetinfo", 1 },
     { "gettxoutproof", 0 },
     { "lockunspent", 0 },
     { "lockunspent", 1 },
@@ -1701,6 +1702,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "zcrawjoinsplit", 4 },
     { "zcbenchmark", 1 },
     { "zcbenchmark", 2 },
+    { "zcbenchmark", 3 },
     { "getblocksubsidy", 0},
     { "z_listaddresses", 0},
     { "z_listreceivedbyaddress", 1},
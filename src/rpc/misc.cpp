@@ -1731,23 +1731,78 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint16
     return true;
 }
 
+// reads the optional "offset", "limit" and "continuation" paging parameters of the address index calls,
+// returning false if none of them are present
+template <typename KeyType>
+bool getAddressIndexPageFromParams(const UniValue& params, CAddressIndexPage<KeyType> &page)
+{
+    UniValue offsetValue = find_value(params[0].get_obj(), "offset");
+    UniValue limitValue = find_value(params[0].get_obj(), "limit");
+    UniValue continuationValue = find_value(params[0].get_obj(), "continuation");
+
+    if (offsetValue.isNull() && limitValue.isNull() && continuationValue.isNull()) {
+        return false;
+    }
+    if (!offsetValue.isNull()) {
+        if (!offsetValue.isNum() || offsetValue.get_int64() < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Offset is expected to be a non-negative number");
+        }
+        page.offset = offsetValue.get_int64();
+    }
+    if (!limitValue.isNull()) {
+        if (!limitValue.isNum() || limitValue.get_int64() <= 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is expected to be greater than zero");
+        }
+        page.limit = limitValue.get_int64();
+    }
+    if (!continuationValue.isNull()) {
+        if (!continuationValue.isStr() || !IsHex(continuationValue.get_str())) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid continuation");
+        }
+        try {
+            KeyType startKey;
+            CDataStream ss(ParseHex(continuationValue.get_str()), SER_DISK, CLIENT_VERSION);
+            ss >> startKey;
+            page.SetStartKey(startKey);
+        } catch (const std::exception &e) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid continuation");
+        }
+    }
+    return true;
+}
+
+template <typename KeyType>
+std::string getAddressIndexContinuation(const CAddressIndexPage<KeyType> &page)
+{
+    if (!page.fMore) {
+        return "";
+    }
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << page.nextKey;
+    return HexStr(ss.begin(), ss.end());
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b) {
     return a.second.blockHeight < b.second.blockHeight;
 }
 
+bool currencyHeightSort(std::pair<CAddressUnspentCurrencyKey, CAddressUnspentCurrencyValue> a,
+                        std::pair<CAddressUnspentCurrencyKey, CAddressUnspentCurrencyValue> b) {
+    return a.second.blockHeight < b.second.blockHeight;
+}
+
 bool timestampSort(std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> a,
                    std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> b) {
     return a.second.time < b.second.time;
 }
 
 
-void CurrencyValuesAndNames(UniValue &output, bool spending, const CScript &script, CAmount satoshis, bool friendlyNames=false);
-void CurrencyValuesAndNames(UniValue &output, bool spending, const CScript &script, CAmount satoshis, bool friendlyNames)
+void CurrencyValuesAndNames(UniValue &output, bool spending, CCurrencyValueMap reserves, CAmount satoshis, bool friendlyNames=false);
+void CurrencyValuesAndNames(UniValue &output, bool spending, CCurrencyValueMap reserves, CAmount satoshis, bool friendlyNames)
 {
     if (CConstVerusSolutionVector::GetVersionByHeight(chainActive.Height()) >= CActivationHeight::ACTIVATE_PBAAS)
     {
-        CCurrencyValueMap reserves = script.ReserveOutValue();
         if (spending)
         {
             reserves = reserves * -1;
@@ -1778,6 +1833,15 @@ void CurrencyValuesAndNames(UniValue &output, bool spending, const CScript &scri
     }
 }
 
+void CurrencyValuesAndNames(UniValue &output, bool spending, const CScript &script, CAmount satoshis, bool friendlyNames=false);
+void CurrencyValuesAndNames(UniValue &output, bool spending, const CScript &script, CAmount satoshis, bool friendlyNames)
+{
+    if (CConstVerusSolutionVector::GetVersionByHeight(chainActive.Height()) >= CActivationHeight::ACTIVATE_PBAAS)
+    {
+        CurrencyValuesAndNames(output, spending, script.ReserveOutValue(), satoshis, friendlyNames);
+    }
+}
+
 void CurrencyValuesAndNames(UniValue &output, bool spending, const CTransaction &tx, int index, CAmount satoshis, bool friendlyNames=false);
 void CurrencyValuesAndNames(UniValue &output, bool spending, const CTransaction &tx, int index, CAmount satoshis, bool friendlyNames)
 {
@@ -2016,6 +2080,8 @@ UniValue getaddressmempool(const UniValue& params, bool fHelp)
     return result;
 }
 
+uint160 ValidateCurrencyName(std::string currencyStr, bool ensureCurrencyValid=false, CCurrencyDefinition *pCurrencyDef=NULL);
+
 UniValue getaddressutxos(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 1)
@@ -2032,6 +2098,10 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
             "  \"chaininfo\"    (boolean) Include chain info with results\n"
             "  \"friendlynames\" (boolean, optional default=false) Include additional array of friendly names keyed by currency i-addresses\n"
             "  \"verbosity\"    (number) (default == 0), if 1, include output information for spends, including all reserve amounts and destinations\n"
+            "  \"offset\"       (number, optional) Skip this many outputs before returning results\n"
+            "  \"limit\"        (number, optional) Return at most this many outputs\n"
+            "  \"continuation\" (string, optional) Resume from the continuation returned by a previous call with the same addresses\n"
+            "  \"currency\"     (string, optional) Only return outputs holding this currency, by name or i-address\n"
             "}\n"
             "\nResult\n"
             "[\n"
@@ -2044,6 +2114,11 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
             "    \"satoshis\"  (number) The number of satoshis of the output\n"
             "  }\n"
             "]\n"
+            "\nIf chaininfo or any of offset, limit or continuation are given, the result is an object with the outputs in \"utxos\".\n"
+            "When paging, outputs are returned in index order, sorted by height within each page, and \"continuation\" is\n"
+            "set if more outputs remain.\n"
+            "When filtering on a currency other than the native currency and the node runs with -addresscurrencyindex,\n"
+            "outputs are read from the currency index and \"script\" and \"isspendable\" are not included.\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}'")
             + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}")
@@ -2058,14 +2133,80 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    CAddressIndexPage<CAddressUnspentKey> page;
+    bool fPaged = getAddressIndexPageFromParams(params, page);
+
     LOCK(cs_main);
 
+    uint160 currencyID;
+    UniValue currencyUni = find_value(params[0].get_obj(), "currency");
+    if (!currencyUni.isNull())
+    {
+        if (fPaged) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "offset, limit and continuation cannot be combined with a currency filter");
+        }
+        currencyID = ValidateCurrencyName(uni_get_str(currencyUni), true);
+        if (currencyID.IsNull()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid currency");
+        }
+    }
+
+    if (!currencyID.IsNull() && currencyID != ASSETCHAINS_CHAINID && fAddressCurrencyIndex)
+    {
+        std::vector<CAddressUnspentCurrencyDbEntry> currencyOutputs;
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (!GetAddressUnspentCurrency((*it).first, (*it).second, currencyID, currencyOutputs)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
+        }
+
+        std::sort(currencyOutputs.begin(), currencyOutputs.end(), currencyHeightSort);
+
+        UniValue utxos(UniValue::VARR);
+        for (auto &oneOutput : currencyOutputs)
+        {
+            UniValue output(UniValue::VOBJ);
+            std::string address;
+            if (!getAddressFromIndex(oneOutput.first.type, oneOutput.first.hashBytes, address)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+            }
+            output.push_back(Pair("address", address));
+            output.push_back(Pair("txid", oneOutput.first.txhash.GetHex()));
+            output.push_back(Pair("outputIndex", (int)oneOutput.first.index));
+            CurrencyValuesAndNames(output, false, CCurrencyValueMap(oneOutput.second.currencyValues), oneOutput.second.satoshis, friendlyNames);
+            output.push_back(Pair("satoshis", oneOutput.second.satoshis));
+            output.push_back(Pair("height", oneOutput.second.blockHeight));
+            if (chainActive.Height() >= oneOutput.second.blockHeight)
+            {
+                output.push_back(Pair("blocktime", chainActive[oneOutput.second.blockHeight]->GetBlockTime()));
+            }
+            utxos.push_back(output);
+        }
+
+        if (includeChainInfo) {
+            UniValue result(UniValue::VOBJ);
+            result.push_back(Pair("utxos", utxos));
+            result.push_back(Pair("hash", chainActive.LastTip()->GetBlockHash().GetHex()));
+            result.push_back(Pair("height", (int)chainActive.Height()));
+            return result;
+        }
+        return utxos;
+    }
+
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
 
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
+    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end() && !page.fMore; it++) {
+        // when resuming, skip the addresses that were completed by earlier pages
+        if (page.fStartKey && (page.startKey.hashBytes != it->first || page.startKey.type != it->second)) {
+            continue;
+        }
+        if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs, fPaged ? &page : nullptr)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
+        page.fStartKey = false;
+    }
+    if (page.fStartKey) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Continuation does not match any of the addresses");
     }
 
     std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
@@ -2073,6 +2214,11 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
     UniValue utxos(UniValue::VARR);
 
     for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=unspentOutputs.begin(); it!=unspentOutputs.end(); it++) {
+        if (!currencyID.IsNull() &&
+            (currencyID == ASSETCHAINS_CHAINID ? it->second.satoshis <= 0 : !it->second.script.ReserveOutValue().valueMap.count(currencyID))) {
+            continue;
+        }
+
         UniValue output(UniValue::VOBJ);
 
         std::string address = "";
@@ -2123,13 +2269,18 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
         utxos.push_back(output);
     }
 
-    if (includeChainInfo) {
+    if (includeChainInfo || fPaged) {
         UniValue result(UniValue::VOBJ);
         result.push_back(Pair("utxos", utxos));
 
-        LOCK(cs_main);
-        result.push_back(Pair("hash", chainActive.LastTip()->GetBlockHash().GetHex()));
-        result.push_back(Pair("height", (int)chainActive.Height()));
+        if (includeChainInfo) {
+            LOCK(cs_main);
+            result.push_back(Pair("hash", chainActive.LastTip()->GetBlockHash().GetHex()));
+            result.push_back(Pair("height", (int)chainActive.Height()));
+        }
+        if (page.fMore) {
+            result.push_back(Pair("continuation", getAddressIndexContinuation(page)));
+        }
         return result;
     } else {
         return utxos;
@@ -2154,6 +2305,9 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
             "  \"chaininfo\" (boolean) Include chain info in results, only applies if start and end specified\n"
             "  \"friendlynames\" (boolean) Include additional array of friendly names keyed by currency i-addresses\n"
             "  \"verbosity\" (number) (default == 0), if 1, include output information for spends, including all reserve amounts and destinations\n"
+            "  \"offset\" (number, optional) Skip this many deltas before returning results\n"
+            "  \"limit\" (number, optional) Return at most this many deltas\n"
+            "  \"continuation\" (string, optional) Resume from the continuation returned by a previous call with the same addresses and range\n"
             "}\n"
             "\nResult:\n"
             "[\n"
@@ -2165,6 +2319,8 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
             "    \"address\"  (string) The base58check encoded address\n"
             "  }\n"
             "]\n"
+            "\nIf any of offset, limit or continuation are given, the result is an object with the deltas in \"deltas\",\n"
+            "and \"continuation\" is set if more deltas remain.\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}'")
             + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}")
@@ -2198,20 +2354,31 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
+    CAddressIndexPage<CAddressIndexKey> page;
+    bool fPaged = getAddressIndexPageFromParams(params, page);
+
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
     {
         LOCK(cs_main);
-        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end() && !page.fMore; it++) {
+            // when resuming, skip the addresses that were completed by earlier pages
+            if (page.fStartKey && (page.startKey.hashBytes != it->first || page.startKey.type != it->second)) {
+                continue;
+            }
             if (start > 0 && end > 0) {
-                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end, fPaged ? &page : nullptr)) {
                     throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
                 }
             } else {
-                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, 0, 0, fPaged ? &page : nullptr)) {
                     throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
                 }
             }
+            page.fStartKey = false;
+        }
+        if (page.fStartKey) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Continuation does not match any of the addresses");
         }
     }
 
@@ -2278,7 +2445,16 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
         result.push_back(Pair("deltas", deltas));
         result.push_back(Pair("start", startInfo));
         result.push_back(Pair("end", endInfo));
+        if (page.fMore) {
+            result.push_back(Pair("continuation", getAddressIndexContinuation(page)));
+        }
 
+        return result;
+    } else if (fPaged) {
+        result.push_back(Pair("deltas", deltas));
+        if (page.fMore) {
+            result.push_back(Pair("continuation", getAddressIndexContinuation(page)));
+        }
         return result;
     } else {
         return deltas;
@@ -2291,6 +2467,8 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
         throw runtime_error(
             "getaddressbalance\n"
             "\nReturns the balance for an address(es) (requires addressindex to be enabled).\n"
+            "When the node runs with -addressbalanceindex, balances are read from running totals rather than\n"
+            "by walking the address history.\n"
             "\nArguments:\n"
             "{\n"
             "  \"addresses\"\n"
@@ -2304,6 +2482,7 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
             "{\n"
             "  \"balance\"  (number) The current balance in satoshis\n"
             "  \"received\"  (number) The total number of satoshis received (including change)\n"
+            "  \"txcount\"  (number) The number of transactions that spent from or paid to each address, summed over all addresses\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}'")
@@ -2319,23 +2498,46 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
+    CAmount balance = 0;
+    CAmount received = 0;
+    int64_t txCount = 0;
+
+    CCurrencyValueMap reserveBalance;
+    CCurrencyValueMap reserveReceived;
+
     LOCK2(cs_main, mempool.cs);
 
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    if (fAddressBalanceIndex)
+    {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            CAddressBalanceValue addressBalance;
+            if (!GetAddressBalance((*it).first, (*it).second, addressBalance)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
+            balance += addressBalance.balance;
+            received += addressBalance.received;
+            txCount += addressBalance.txCount;
+            reserveBalance += CCurrencyValueMap(addressBalance.currencyBalance);
+            reserveReceived += CCurrencyValueMap(addressBalance.currencyReceived);
+        }
+    }
+    else
+    {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
         }
     }
 
     CTransaction curTx;
-
-    CAmount balance = 0;
-    CAmount received = 0;
-
-    CCurrencyValueMap reserveBalance;
-    CCurrencyValueMap reserveReceived;
+    std::set<std::tuple<unsigned int, uint160, uint256>> txSeen;
 
     for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+        if (txSeen.insert(std::make_tuple(it->first.type, it->first.hashBytes, it->first.txhash)).second) {
+            txCount++;
+        }
+
         uint256 blockHash;
         if (!it->first.txhash.IsNull() && (it->first.txhash == curTx.GetHash() || myGetTransaction(it->first.txhash, curTx, blockHash)))
         {
@@ -2366,6 +2568,7 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
     UniValue result(UniValue::VOBJ);
     result.push_back(Pair("balance", balance));
     result.push_back(Pair("received", received));
+    result.push_back(Pair("txcount", txCount));
 
     if (CConstVerusSolutionVector::GetVersionByHeight(chainActive.Height()) >= CActivationHeight::ACTIVATE_PBAAS)
     {
@@ -14893,6 +14893,33 @@ UniValue getidentitytrust(const UniValue& params, bool fHelp)
     return retVal;
 }
 
+UniValue getidentitycacheinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+    {
+        throw runtime_error(
+            "getidentitycacheinfo\n"
+            "\nReturns usage statistics of the in-memory cache of identity lookups, which is cleared on every block connected or disconnected\n"
+
+            "\nResult:\n"
+            "{\n"
+            "  \"entries\":<n>                  (int) number of identity lookups currently cached\n"
+            "  \"hits\":<n>                     (int) lookups answered from the cache since startup\n"
+            "  \"misses\":<n>                   (int) lookups that had to read the indexes since startup\n"
+            "  \"hitrate\":<n>                  (numeric) hits / (hits + misses)\n"
+            "  \"invalidations\":<n>            (int) number of times the cache was cleared due to a block connected or disconnected\n"
+            "  \"staleputs\":<n>                (int) lookup results dropped because the cache was cleared while they were read\n"
+            "}\n"
+
+            "\nExamples:\n"
+            + HelpExampleCli("getidentitycacheinfo", "")
+            + HelpExampleRpc("getidentitycacheinfo", "")
+        );
+    }
+
+    return IdentityCache.ToUniValue();
+}
+
 UniValue setcurrencytrust(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 1)
@@ -15592,6 +15619,7 @@ static const CRPCCommand commands[] =
     { "identity",     "getidentitieswithrecovery",    &getidentitieswithrecovery, true  },
     { "identity",     "setidentitytrust",             &setidentitytrust,       true  },
     { "identity",     "getidentitytrust",             &getidentitytrust,       true  },
+    { "identity",     "getidentitycacheinfo",         &getidentitycacheinfo,   true  },
     { "multichain",   "setcurrencytrust",             &setcurrencytrust,       true  },
     { "multichain",   "getcurrencytrust",             &getcurrencytrust,       true  },
     { "multichain",   "estimateconversion",           &estimateconversion,     true  },
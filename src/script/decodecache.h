@@ -0,0 +1,97 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_SCRIPT_DECODECACHE_H
+#define BITCOIN_SCRIPT_DECODECACHE_H
+
+#include "pbaas/crosschainrpc.h"
+#include "script/script.h"
+
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+
+// While a block is connected, the same output scripts are parsed again and again, by precheck, contract validation,
+// index updates and wallet sync. A CBlockScriptCache on the stack of the thread connecting the block holds the result
+// of parsing each distinct output script and of decoding the objects in it, so each is only done once for the block.
+// Parsing is a pure function of the script bytes, which are the key, so any caller that only holds a script benefits.
+// Only the thread that created the cache uses it. Other threads, such as script check threads, parse as before.
+class CBlockScriptCache
+{
+public:
+    // bound on the memory of one block's cache. scripts beyond this are parsed as if there were no cache
+    static const size_t MAX_ENTRIES = 50000;
+
+    struct CEntry
+    {
+        bool haveParams;
+        bool isPayToCryptoCondition;
+        COptCCParams params;
+        bool haveReserveOut;
+        CCurrencyValueMap reserveOut;       // reserve value of the output, before any spendable only filter
+        std::map<std::type_index, std::shared_ptr<const void>> objects;
+
+        CEntry() : haveParams(false), isPayToCryptoCondition(false), haveReserveOut(false) {}
+    };
+
+    uint64_t nDecoded;                      // scripts parsed and objects decoded
+    uint64_t nReused;                       // parses and decodes answered from the cache instead
+
+    CBlockScriptCache();
+    ~CBlockScriptCache();
+
+    // the cache of the block being connected on this thread, or nullptr if there is none
+    static CBlockScriptCache *GetActive() { return pActive; }
+
+    // the entry of the script in the active cache, added if not present, or nullptr if there is no room or no cache
+    static CEntry *GetEntry(const CScript &script);
+
+    // the object of type OBJECT decoded from script, if it has been decoded in this block
+    template <typename OBJECT>
+    static bool GetObject(const CScript &script, OBJECT &obj)
+    {
+        CEntry *pEntry = GetEntry(script);
+        if (pEntry)
+        {
+            auto it = pEntry->objects.find(std::type_index(typeid(OBJECT)));
+            if (it != pEntry->objects.end())
+            {
+                obj = *std::static_pointer_cast<const OBJECT>(it->second);
+                pActive->nReused++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename OBJECT>
+    static void PutObject(const CScript &script, const OBJECT &obj)
+    {
+        CEntry *pEntry = GetEntry(script);
+        if (pEntry)
+        {
+            pEntry->objects[std::type_index(typeid(OBJECT))] = std::make_shared<const OBJECT>(obj);
+            pActive->nDecoded++;
+        }
+    }
+
+private:
+    // script bytes are chosen by whoever makes the transactions, so they are hashed with a per process random salt,
+    // which keeps scripts made to collide from filling one bucket
+    struct CScriptContentHasher
+    {
+        size_t operator()(const CScript &script) const;
+    };
+
+    static thread_local CBlockScriptCache *pActive;
+
+    std::unordered_map<CScript, CEntry, CScriptContentHasher> entries;
+    CBlockScriptCache *pPrevious;
+
+    CBlockScriptCache(const CBlockScriptCache &) = delete;
+    CBlockScriptCache &operator=(const CBlockScriptCache &) = delete;
+};
+
+#endif // BITCOIN_SCRIPT_DECODECACHE_H
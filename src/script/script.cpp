@@ -4,6 +4,9 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "script.h"
+#include "script/decodecache.h"
+#include "crypto/sha256.h"
+#include "random.h"
 
 #include "tinyformat.h"
 #include "utilstrencodings.h"
@@ -664,16 +667,77 @@ bool CScript::IsInstantSpendOrUnspendable() const
     return isInstantSpend;
 }
 
-bool CScript::IsPayToCryptoCondition(COptCCParams &ccParams, bool doSizeCheck) const
+thread_local CBlockScriptCache *CBlockScriptCache::pActive = nullptr;
+
+CBlockScriptCache::CBlockScriptCache() : nDecoded(0), nReused(0), pPrevious(pActive)
 {
-    CScript subScript;
-    std::vector<std::vector<unsigned char>> vParams;
+    pActive = this;
+}
+
+CBlockScriptCache::~CBlockScriptCache()
+{
+    pActive = pPrevious;
+}
+
+size_t CBlockScriptCache::CScriptContentHasher::operator()(const CScript &script) const
+{
+    static const uint256 salt = GetRandHash();
+    uint256 digest;
+    CSHA256().Write(salt.begin(), salt.size())
+             .Write(script.empty() ? NULL : &script[0], script.size())
+             .Finalize(digest.begin());
+    return digest.GetCheapHash();
+}
+
+CBlockScriptCache::CEntry *CBlockScriptCache::GetEntry(const CScript &script)
+{
+    if (!pActive)
+    {
+        return nullptr;
+    }
+    auto it = pActive->entries.find(script);
+    if (it != pActive->entries.end())
+    {
+        return &it->second;
+    }
+    if (pActive->entries.size() >= MAX_ENTRIES)
+    {
+        return nullptr;
+    }
+    return &pActive->entries[script];
+}
 
+bool CScript::IsPayToCryptoCondition(COptCCParams &ccParams, bool doSizeCheck) const
+{
     if (!size() || (doSizeCheck && size() > MAX_SCRIPT_SIZE))
     {
         return false;
     }
 
+    CBlockScriptCache::CEntry *pEntry = CBlockScriptCache::GetEntry(*this);
+    if (pEntry)
+    {
+        if (pEntry->haveParams)
+        {
+            CBlockScriptCache::GetActive()->nReused++;
+        }
+        else
+        {
+            pEntry->isPayToCryptoCondition = DecodeCryptoConditionParams(pEntry->params);
+            pEntry->haveParams = true;
+            CBlockScriptCache::GetActive()->nDecoded++;
+        }
+        ccParams = pEntry->params;
+        return pEntry->isPayToCryptoCondition;
+    }
+    return DecodeCryptoConditionParams(ccParams);
+}
+
+bool CScript::DecodeCryptoConditionParams(COptCCParams &ccParams) const
+{
+    CScript subScript;
+    std::vector<std::vector<unsigned char>> vParams;
+
     if (IsPayToCryptoCondition(&subScript, vParams))
     {
         if (!vParams.empty())
@@ -801,6 +865,13 @@ CCurrencyValueMap CScript::ReserveOutValue(COptCCParams &p, bool spendableOnly)
     // already validated above
     if (IsPayToCryptoCondition(p) && p.IsValid() && (!spendableOnly || IsSpendableOutputType(p)) && p.vData.size())
     {
+        CBlockScriptCache::CEntry *pEntry = CBlockScriptCache::GetEntry(*this);
+        if (pEntry && pEntry->haveReserveOut)
+        {
+            CBlockScriptCache::GetActive()->nReused++;
+            return pEntry->reserveOut;
+        }
+
         switch (p.evalCode)
         {
             case EVAL_RESERVE_OUTPUT:
@@ -851,6 +922,13 @@ CCurrencyValueMap CScript::ReserveOutValue(COptCCParams &p, bool spendableOnly)
                 }
             }
         }
+
+        if (pEntry)
+        {
+            pEntry->reserveOut = retVal;
+            pEntry->haveReserveOut = true;
+            CBlockScriptCache::GetActive()->nDecoded++;
+        }
     }
     return retVal;
 }
@@ -1990,46 +2068,46 @@ bool operator>=(const CCurrencyValueMap& a, const CCurrencyValueMap& b)
     return b <= a;
 }
 
-CCurrencyValueMap operator+(const CCurrencyValueMap& a, const CCurrencyValueMap& b)
+// both maps are sorted by currency, so sums and differences are a single merge, appending each result in order
+static CCurrencyValueMap MergeCurrencyValues(const CCurrencyValueMap& a, const CCurrencyValueMap& b, int64_t bSign)
 {
-    CCurrencyValueMap retVal = a;
-    if (a.valueMap.size() || b.valueMap.size())
+    CCurrencyValueMap retVal;
+    if (!b.valueMap.size())
+    {
+        retVal = a;
+        return retVal;
+    }
+    retVal.valueMap.reserve(a.valueMap.size() + b.valueMap.size());
+    auto aIt = a.valueMap.begin(), bIt = b.valueMap.begin();
+    while (aIt != a.valueMap.end() || bIt != b.valueMap.end())
     {
-        for (auto &oneVal : b.valueMap)
+        if (bIt == b.valueMap.end() || (aIt != a.valueMap.end() && aIt->first < bIt->first))
         {
-            auto it = retVal.valueMap.find(oneVal.first);
-            if (it == retVal.valueMap.end())
-            {
-                retVal.valueMap[oneVal.first] = oneVal.second;
-            }
-            else
-            {
-                it->second += oneVal.second;
-            }
+            retVal.valueMap.insert(retVal.valueMap.end(), *aIt++);
+        }
+        else if (aIt == a.valueMap.end() || bIt->first < aIt->first)
+        {
+            retVal.valueMap.insert(retVal.valueMap.end(), std::make_pair(bIt->first, bSign * bIt->second));
+            bIt++;
+        }
+        else
+        {
+            retVal.valueMap.insert(retVal.valueMap.end(), std::make_pair(aIt->first, aIt->second + bSign * bIt->second));
+            aIt++;
+            bIt++;
         }
     }
     return retVal;
 }
 
+CCurrencyValueMap operator+(const CCurrencyValueMap& a, const CCurrencyValueMap& b)
+{
+    return MergeCurrencyValues(a, b, 1);
+}
+
 CCurrencyValueMap operator-(const CCurrencyValueMap& a, const CCurrencyValueMap& b)
 {
-    CCurrencyValueMap retVal = a;
-    if (a.valueMap.size() || b.valueMap.size())
-    {
-        for (auto &oneVal : b.valueMap)
-        {
-            auto it = retVal.valueMap.find(oneVal.first);
-            if (it == retVal.valueMap.end())
-            {
-                retVal.valueMap[oneVal.first] = -oneVal.second;
-            }
-            else
-            {
-                it->second -= oneVal.second;
-            }
-        }
-    }
-    return retVal;
+    return MergeCurrencyValues(a, b, -1);
 }
 
 CCurrencyValueMap operator+(const CCurrencyValueMap& a, int b)
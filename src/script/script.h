@@ -775,6 +775,7 @@ public:
     bool GetOpretData(std::vector<std::vector<unsigned char>>& vData) const;
 
     bool IsPayToCryptoCondition(COptCCParams &ccParams, bool doSizeCheck=true) const;
+    bool DecodeCryptoConditionParams(COptCCParams &ccParams) const;    // uncached parse, without the size check
     bool IsPayToCryptoCondition(CScript *ccSubScript, std::vector<std::vector<unsigned char>> &vParams, COptCCParams &optParams) const;
     bool IsPayToCryptoCondition(CScript *ccSubScript, std::vector<std::vector<unsigned char>> &vParams) const;
     bool IsPayToCryptoCondition(CScript *ccSubScript) const;
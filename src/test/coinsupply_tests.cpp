@@ -0,0 +1,131 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "coinsupplyindex.h"
+#include "main.h"
+#include "random.h"
+#include "undo.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(coinsupply_tests, TestingSetup)
+
+// a block's change in supply, recomputed the way the coin supply used to be backfilled, by looking up the outputs its
+// inputs spend in the transactions that created them rather than in its undo data
+static int64_t RecomputeNewCoins(const CBlock &block, const std::map<uint256, CTransaction> &txs)
+{
+    int64_t newCoins = 0;
+    for (auto &tx : block.vtx)
+    {
+        for (auto &out : tx.vout)
+        {
+            if (tx.IsCoinBase() || !out.scriptPubKey.IsOpReturn())
+            {
+                newCoins += out.nValue;
+            }
+        }
+        if (!tx.IsCoinBase())
+        {
+            for (auto &in : tx.vin)
+            {
+                newCoins -= txs.find(in.prevout.hash)->second.vout[in.prevout.n].nValue;
+            }
+        }
+    }
+    return newCoins;
+}
+
+BOOST_AUTO_TEST_CASE(coin_supply_index_matches_recomputed_supply)
+{
+    const int numBlocks = 5;
+    std::vector<CBlock> blocks(numBlocks + 1);
+    std::vector<CBlockUndo> undos(numBlocks + 1);
+    std::vector<uint256> hashes(numBlocks + 1);
+    std::vector<CBlockIndex> indices(numBlocks + 1);
+    std::map<uint256, CTransaction> txs;
+    CScript script = CScript() << OP_TRUE;
+
+    int64_t recomputedSupply = 0, chainImmature = 0;
+    for (int height = 1; height <= numBlocks; height++)
+    {
+        CBlock &block = blocks[height];
+        CBlockUndo &blockundo = undos[height];
+
+        CMutableTransaction coinbase;
+        coinbase.vin.push_back(CTxIn(COutPoint(), CScript() << height << OP_0));
+        coinbase.vout.push_back(CTxOut(12 * COIN, script));
+        coinbase.vout.push_back(CTxOut(0, CScript() << OP_RETURN));
+        block.vtx.push_back(coinbase);
+
+        // spend the previous coinbase, burning one coin in an OP_RETURN and leaving one as fee
+        if (height > 1)
+        {
+            const CTransaction &prevCoinbase = blocks[height - 1].vtx[0];
+            CMutableTransaction spend;
+            spend.vin.push_back(CTxIn(prevCoinbase.GetHash(), 0));
+            spend.vout.push_back(CTxOut(10 * COIN, script));
+            spend.vout.push_back(CTxOut(COIN, CScript() << OP_RETURN));
+            block.vtx.push_back(spend);
+
+            blockundo.vtxundo.push_back(CTxUndo());
+            blockundo.vtxundo.back().vprevout.push_back(CTxInUndo(prevCoinbase.vout[0], true, height - 1));
+        }
+        for (auto &tx : block.vtx)
+        {
+            txs[tx.GetHash()] = tx;
+        }
+
+        block.hashMerkleRoot = block.BuildMerkleTree();
+        hashes[height] = block.GetHash();
+        indices[height].phashBlock = &hashes[height];
+        indices[height].pprev = height > 1 ? &indices[height - 1] : NULL;
+        indices[height].SetHeight(height);
+
+        // what ConnectBlock writes as each block is connected
+        CCoinSupplyIndexValue value;
+        BOOST_CHECK(GetBlockCoinSupply(&indices[height], block, blockundo, value));
+        BOOST_CHECK(WriteCoinSupplyIndex(&indices[height], value));
+
+        recomputedSupply += RecomputeNewCoins(block, txs);
+        chainImmature += value.immature;
+        BOOST_CHECK_EQUAL(value.newCoins, RecomputeNewCoins(block, txs));
+        BOOST_CHECK_EQUAL(value.newCoins, height == 1 ? 12 * COIN : 10 * COIN);
+        BOOST_CHECK_EQUAL(value.chainSupply, recomputedSupply);
+        BOOST_CHECK_EQUAL(value.chainImmature, chainImmature);
+    }
+    BOOST_CHECK_EQUAL(recomputedSupply, 52 * COIN);
+
+    // the backfill of a chain synced before the index runs the same computation later, from the block and undo data read
+    // back from disk, and must arrive at the entries that were written when the blocks were connected
+    for (int height = 1; height <= numBlocks; height++)
+    {
+        CCoinSupplyIndexValue connected, backfilled;
+        BOOST_CHECK(GetCoinSupplyIndex(&indices[height], connected));
+        BOOST_CHECK(GetBlockCoinSupply(&indices[height], blocks[height], undos[height], backfilled));
+        BOOST_CHECK_EQUAL(connected.newCoins, backfilled.newCoins);
+        BOOST_CHECK_EQUAL(connected.immature, backfilled.immature);
+        BOOST_CHECK_EQUAL(connected.maturity, backfilled.maturity);
+        BOOST_CHECK_EQUAL(connected.chainSupply, backfilled.chainSupply);
+        BOOST_CHECK_EQUAL(connected.chainZFunds, backfilled.chainZFunds);
+        BOOST_CHECK_EQUAL(connected.chainImmature, backfilled.chainImmature);
+        BOOST_CHECK(connected.timeLocked == backfilled.timeLocked);
+    }
+
+    // no entry without the parent's, or with undo data that does not match the block
+    CBlockIndex orphan;
+    uint256 orphanHash = GetRandHash();
+    CBlockIndex orphanParent;
+    uint256 orphanParentHash = GetRandHash();
+    orphanParent.phashBlock = &orphanParentHash;
+    orphanParent.SetHeight(numBlocks);
+    orphan.phashBlock = &orphanHash;
+    orphan.pprev = &orphanParent;
+    orphan.SetHeight(numBlocks + 1);
+    CCoinSupplyIndexValue value;
+    BOOST_CHECK(!GetBlockCoinSupply(&orphan, blocks[2], undos[2], value));
+    BOOST_CHECK(!GetBlockCoinSupply(&indices[2], blocks[2], undos[1], value));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,7 +8,10 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "crypto/muhash.h"
 #include "random.h"
+#include "streams.h"
+#include "uint256.h"
 #include "utilstrencodings.h"
 #include "test/test_bitcoin.h"
 
@@ -248,4 +251,51 @@ BOOST_AUTO_TEST_CASE(hmac_sha512_testvectors) {
                    "b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58");
 }
 
+static MuHash3072 FromInt(unsigned char i) {
+    unsigned char tmp[32] = {i, 0};
+    return MuHash3072(tmp, 32);
+}
+
+BOOST_AUTO_TEST_CASE(muhash_tests) {
+    // the set {0, 1} with 2 removed, as in Bitcoin Core
+    uint256 out;
+    MuHash3072 acc = FromInt(0);
+    acc *= FromInt(1);
+    acc /= FromInt(2);
+    acc.Finalize(out);
+    BOOST_CHECK(out == uint256S("10d312b100cbd32ada024a6646e40d3482fcff103668d2625f10002a607d5863"));
+
+    // the hash of a set does not depend on the order of insertions and removals, or on how they are grouped
+    for (int iter = 0; iter < 10; iter++) {
+        unsigned char x = insecure_rand() & 0xff, y = insecure_rand() & 0xff, z = insecure_rand() & 0xff;
+        uint256 out1, out2, out3;
+        MuHash3072 first;
+        first.Insert(&x, 1).Insert(&y, 1).Remove(&z, 1);
+        MuHash3072 second;
+        second.Remove(&z, 1).Insert(&y, 1).Insert(&x, 1);
+        MuHash3072 third(&y, 1);
+        third *= MuHash3072(&x, 1);
+        third /= MuHash3072(&z, 1);
+        first.Finalize(out1);
+        second.Finalize(out2);
+        third.Finalize(out3);
+        BOOST_CHECK(out1 == out2);
+        BOOST_CHECK(out1 == out3);
+    }
+
+    // removing everything that was inserted gives the empty set, also after a round trip through serialization
+    uint256 empty, removed;
+    MuHash3072().Finalize(empty);
+    MuHash3072 inserted = FromInt(3);
+    inserted *= FromInt(4);
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << inserted;
+    MuHash3072 restored;
+    ss >> restored;
+    restored /= FromInt(3);
+    restored /= FromInt(4);
+    restored.Finalize(removed);
+    BOOST_CHECK(empty == removed);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
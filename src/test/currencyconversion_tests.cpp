@@ -0,0 +1,116 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "arith_uint256.h"
+#include "pbaas/reserves.h"
+#include "random.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(currencyconversion_tests, BasicTestingSetup)
+
+// random values of every magnitude, of either sign
+static int64_t RandomAmount()
+{
+    uint64_t value = ((uint64_t)insecure_rand() << 32) | insecure_rand();
+    value >>= insecure_rand() % 64;
+    return (insecure_rand() & 7) ? (int64_t)(value >> 1) : -(int64_t)(value >> 1);
+}
+
+static int32_t RandomWeight()
+{
+    int32_t weight = insecure_rand() % (CCurrencyState::MAX_RESERVE_RATIO + 1);
+    return (insecure_rand() & 15) ? weight : -weight;
+}
+
+BOOST_AUTO_TEST_CASE(multiply_divide_matches_arith_uint256)
+{
+    seed_insecure_rand(true);
+    for (int i = 0; i < 100000; i++)
+    {
+        int64_t a = RandomAmount(), b = (i & 1) ? SATOSHIDEN : RandomAmount(), c = RandomAmount();
+        if (!c)
+        {
+            continue;
+        }
+        arith_uint256 reference = (arith_uint256(a) * arith_uint256(b)) / arith_uint256(c);
+        unsigned __int128 quotient = CCurrencyState::MultiplyDivide(a, b, c);
+        BOOST_CHECK_EQUAL(reference.GetLow64(), (uint64_t)quotient);
+        BOOST_CHECK_EQUAL((reference >> 64).GetLow64(), (uint64_t)(quotient >> 64));
+        BOOST_CHECK((reference >> 128) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(price_matches_decfloat)
+{
+    seed_insecure_rand(true);
+    CCurrencyState state(uint160(), std::vector<uint160>(1), std::vector<int32_t>(1), std::vector<int64_t>(1), 0, 0, 0,
+                         CCurrencyState::FLAG_FRACTIONAL);
+    for (int i = 0; i < 20000; i++)
+    {
+        state.supply = (i % 100) ? RandomAmount() : 0;
+        state.reserves[0] = (i % 50) ? RandomAmount() : 0;
+        state.weights[0] = (i % 200) ? RandomWeight() : 0;
+        if (i % 1000 == 0)
+        {
+            // extremes, which saturate the truncated price
+            state.supply = ((i / 1000) & 1) ? 1 : -1;
+            state.reserves[0] = ((i / 1000) & 2) ? INT64_MAX : INT64_MIN;
+        }
+
+        int64_t reference;
+        BOOST_CHECK(CCurrencyState::to_int64(state.PriceInReserveDecFloat50(), reference));
+        BOOST_CHECK_EQUAL(state.PriceInReserveTruncated(), reference);
+
+        if (state.supply && state.weights[0])
+        {
+            arith_uint256 numerator = arith_uint256(state.reserves[0] ? state.reserves[0] : SATOSHIDEN) * arith_uint256(SATOSHIDEN) * arith_uint256(SATOSHIDEN);
+            arith_uint256 denominator = arith_uint256(state.supply) * arith_uint256(state.weights[0]);
+            arith_uint256 truncated = numerator / denominator;
+            int64_t roundedUp = truncated.GetLow64();
+            if ((numerator - truncated * denominator).GetLow64() && (roundedUp + 1) > 0)
+            {
+                roundedUp++;
+            }
+            BOOST_CHECK_EQUAL(state.PriceInReserve(0, false), (int64_t)truncated.GetLow64());
+            BOOST_CHECK_EQUAL(state.PriceInReserve(0, true), roundedUp);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(raw_conversions_match_decfloat)
+{
+    seed_insecure_rand(true);
+    for (int i = 0; i < 20000; i++)
+    {
+        int64_t amount = RandomAmount();
+        int64_t rate = RandomAmount();
+        cpp_dec_float_50 decRate(std::to_string(rate));
+
+        // amounts are taken as unsigned 64 bit values, and anything that does not fit in 64 bits returns -1
+        arith_uint256 bigNative = rate ? (arith_uint256(amount) * arith_uint256(SATOSHIDEN)) / arith_uint256(rate) : arith_uint256(0);
+        CAmount native = CCurrencyState::ReserveToNativeRaw(amount, rate);
+        BOOST_CHECK_EQUAL(native, (bigNative >> 64) == 0 ? (int64_t)bigNative.GetLow64() : -1);
+        if (amount >= 0 && rate > 0 && bigNative <= INT64_MAX)
+        {
+            BOOST_CHECK_EQUAL(native, CCurrencyState::ReserveToNativeRaw(amount, decRate));
+        }
+
+        // the rate is multiplied as it was before, by arith_uint256's uint32_t operator, which takes it modulo 2^32
+        arith_uint256 bigReserve = (arith_uint256(amount) * rate) / arith_uint256(SATOSHIDEN);
+        CAmount reserve = CCurrencyState::NativeToReserveRaw(amount, rate);
+        BOOST_CHECK_EQUAL(reserve, (bigReserve >> 64) == 0 ? (int64_t)bigReserve.GetLow64() : -1);
+        if (amount >= 0 && rate >= 0 && rate <= UINT32_MAX && bigReserve <= INT64_MAX)
+        {
+            BOOST_CHECK_EQUAL(reserve, CCurrencyState::NativeToReserveRaw(amount, decRate));
+        }
+    }
+
+    // rates of 2^32 and above keep their low 32 bits
+    BOOST_CHECK_EQUAL(CCurrencyState::NativeToReserveRaw(SATOSHIDEN, ((int64_t)1 << 32) + 5), 5);
+    BOOST_CHECK_EQUAL(CCurrencyState::NativeGasToReserveRaw(SATOSHIDEN * 1000, (((int64_t)1 << 32) + 5) * (SATOSHIDEN / 100)), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -229,6 +229,49 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_profiles)
+{
+    CDBOptionsProfile profile;
+    BOOST_CHECK(GetDBOptionsProfile("default", profile));
+    BOOST_CHECK_EQUAL(profile.bloomBits, 10);
+    BOOST_CHECK_EQUAL(profile.blockCachePercent, 50);
+    BOOST_CHECK_EQUAL(profile.writeBufferPercent, 25);
+    BOOST_CHECK(!GetDBOptionsProfile("nosuchprofile", profile));
+
+    BOOST_CHECK(GetDBOptionsProfile("scan", profile));
+    BOOST_CHECK(profile.SetOption("bloombits", "12"));
+    BOOST_CHECK_EQUAL(profile.bloomBits, 12);
+    BOOST_CHECK(!profile.SetOption("bloombits", "twelve"));
+    BOOST_CHECK(!profile.SetOption("writebuffer", "60"));
+    BOOST_CHECK(!profile.SetOption("nosuchoption", "1"));
+
+    mapMultiArgs["-dbprofile"].push_back("testdb:pointread");
+    mapMultiArgs["-dbopt"].push_back("testdb:blocksize=8192");
+    mapMultiArgs["-dbopt"].push_back("otherdb:blocksize=65536");
+    profile = GetConfiguredDBOptionsProfile("testdb");
+    BOOST_CHECK_EQUAL(profile.name, "pointread");
+    BOOST_CHECK_EQUAL(profile.blockSize, 8192);
+
+    {
+        path ph = temp_directory_path() / unique_path();
+        CDBWrapper dbw(ph, (1 << 20), true, false, false, 64, "testdb");
+        char key = 'k';
+        uint256 in = GetRandHash();
+        uint256 res;
 
+        BOOST_CHECK(dbw.Write(key, in));
+        BOOST_CHECK(dbw.Read(key, res));
+
+        CDBWrapperStats stats = dbw.GetStats();
+        BOOST_CHECK_EQUAL(stats.name, "testdb");
+        BOOST_CHECK_EQUAL(stats.profile, "pointread");
+        BOOST_CHECK_EQUAL(stats.blockCacheSize, (1 << 20) / 100 * 60);
+        BOOST_CHECK_EQUAL(GetAllDBWrapperStats().size(), 1);
+    }
+    BOOST_CHECK_EQUAL(GetAllDBWrapperStats().size(), 0);
+
+    mapMultiArgs.erase("-dbprofile");
+    mapMultiArgs.erase("-dbopt");
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/identity.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(identitycache_tests, BasicTestingSetup)
+
+static CIdentity TestIdentity(const uint160 &revocation)
+{
+    CIdentity identity;
+    identity.nVersion = CIdentity::VERSION_CURRENT;
+    identity.name = "cachetest";
+    identity.revocationAuthority = revocation;
+    identity.recoveryAuthority = revocation;
+    return identity;
+}
+
+// follows the order LookupIdentity uses: read the generation, read the indexes, then put the result
+static CIdentity CachedLookup(CIdentityCache &cache, const CIdentityCache::CIdentityCacheKey &key, const CIdentity &indexed, bool *pFromCache=nullptr)
+{
+    CIdentityCache::CIdentityCacheValue value;
+    uint64_t generation = cache.Generation();
+    if (cache.Get(key, value))
+    {
+        if (pFromCache)
+        {
+            *pFromCache = true;
+        }
+        return std::get<0>(value);
+    }
+    if (pFromCache)
+    {
+        *pFromCache = false;
+    }
+    cache.Put(key, CIdentityCache::CIdentityCacheValue(indexed, 1, CTxIn()), generation);
+    return indexed;
+}
+
+BOOST_AUTO_TEST_CASE(lookup_after_connect_returns_updated_identity)
+{
+    CIdentityCache cache;
+    CIdentity before = TestIdentity(uint160(ParseHex("0101010101010101010101010101010101010101")));
+    CIdentity after = TestIdentity(uint160(ParseHex("0202020202020202020202020202020202020202")));
+    CIdentityCache::CIdentityCacheKey key(before.GetID(), 0);
+
+    bool fromCache;
+    BOOST_CHECK(CachedLookup(cache, key, before, &fromCache).revocationAuthority == before.revocationAuthority);
+    BOOST_CHECK(!fromCache);
+    BOOST_CHECK(CachedLookup(cache, key, before, &fromCache).revocationAuthority == before.revocationAuthority);
+    BOOST_CHECK(fromCache);
+
+    // ConnectBlock writes the update to the indexes, then clears the cache
+    cache.Clear();
+
+    BOOST_CHECK(CachedLookup(cache, key, after, &fromCache).revocationAuthority == after.revocationAuthority);
+    BOOST_CHECK(!fromCache);
+    BOOST_CHECK(CachedLookup(cache, key, after, &fromCache).revocationAuthority == after.revocationAuthority);
+    BOOST_CHECK(fromCache);
+}
+
+BOOST_AUTO_TEST_CASE(put_from_older_generation_is_dropped)
+{
+    CIdentityCache cache;
+    CIdentity before = TestIdentity(uint160(ParseHex("0101010101010101010101010101010101010101")));
+    CIdentity after = TestIdentity(uint160(ParseHex("0202020202020202020202020202020202020202")));
+    CIdentityCache::CIdentityCacheKey key(before.GetID(), 0);
+    CIdentityCache::CIdentityCacheValue value;
+
+    // a lookup reads the indexes before the block connects, but stores its result after
+    uint64_t generation = cache.Generation();
+    cache.Clear();
+    BOOST_CHECK(generation != cache.Generation());
+    BOOST_CHECK(!cache.Put(key, CIdentityCache::CIdentityCacheValue(before, 1, CTxIn()), generation));
+    BOOST_CHECK(!cache.Get(key, value));
+
+    // the next lookup sees the block's update
+    BOOST_CHECK(CachedLookup(cache, key, after).revocationAuthority == after.revocationAuthority);
+    BOOST_CHECK(cache.Get(key, value));
+    BOOST_CHECK(std::get<0>(value).revocationAuthority == after.revocationAuthority);
+
+    UniValue info = cache.ToUniValue();
+    BOOST_CHECK_EQUAL(find_value(info, "staleputs").get_int64(), 1);
+    BOOST_CHECK_EQUAL(find_value(info, "invalidations").get_int64(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
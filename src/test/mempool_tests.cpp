@@ -157,6 +157,421 @@ BOOST_AUTO_TEST_CASE(MempoolIndexingTest)
     BOOST_CHECK(it == pool.mapTx.get<1>().end());
 }
 
+BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+    entry.hadNoDependencies = true;
+
+    CMutableTransaction tx1 = CMutableTransaction();
+    tx1.vin.resize(1);
+    tx1.vin[0].scriptSig = CScript() << OP_1;
+    tx1.vout.resize(1);
+    tx1.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx1.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(tx1.GetHash(), entry.Fee(10000LL).FromTx(tx1));
+
+    CMutableTransaction tx2 = CMutableTransaction();
+    tx2.vin.resize(1);
+    tx2.vin[0].scriptSig = CScript() << OP_2;
+    tx2.vout.resize(1);
+    tx2.vout[0].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+    tx2.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(tx2.GetHash(), entry.Fee(5000LL).FromTx(tx2));
+
+    // a child of tx2 is evicted with it
+    CMutableTransaction tx3 = CMutableTransaction();
+    tx3.vin.resize(1);
+    tx3.vin[0].prevout = COutPoint(tx2.GetHash(), 0);
+    tx3.vin[0].scriptSig = CScript() << OP_2;
+    tx3.vout.resize(1);
+    tx3.vout[0].scriptPubKey = CScript() << OP_3 << OP_EQUAL;
+    tx3.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(tx3.GetHash(), entry.Fee(20000LL).FromTx(tx3));
+
+    // the lowest fee rate, until it is prioritised above tx1
+    CMutableTransaction tx4 = CMutableTransaction();
+    tx4.vin.resize(1);
+    tx4.vin[0].scriptSig = CScript() << OP_4;
+    tx4.vout.resize(1);
+    tx4.vout[0].scriptPubKey = CScript() << OP_4 << OP_EQUAL;
+    tx4.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(tx4.GetHash(), entry.Fee(1000LL).FromTx(tx4));
+    pool.PrioritiseTransaction(tx4.GetHash(), tx4.GetHash().ToString(), 0, 50000LL);
+
+    BOOST_CHECK_EQUAL(pool.size(), 4);
+    BOOST_CHECK_EQUAL(pool.TrimToSize(pool.DynamicMemoryUsage()), 0);
+    BOOST_CHECK_EQUAL(pool.size(), 4);
+
+    std::vector<uint256> vNoSpendsRemaining;
+    BOOST_CHECK_EQUAL(pool.TrimToSize(pool.DynamicMemoryUsage() - 1, &vNoSpendsRemaining), 2);
+    BOOST_CHECK(pool.exists(tx1.GetHash()));
+    BOOST_CHECK(!pool.exists(tx2.GetHash()));
+    BOOST_CHECK(!pool.exists(tx3.GetHash()));
+    BOOST_CHECK(pool.exists(tx4.GetHash()));
+    BOOST_CHECK_EQUAL(pool.GetEvictedCount(), 2);
+
+    // the confirmed transaction tx2 spent is no longer spent by the pool
+    BOOST_CHECK(std::find(vNoSpendsRemaining.begin(), vNoSpendsRemaining.end(), tx2.vin[0].prevout.hash) != vNoSpendsRemaining.end());
+
+    BOOST_CHECK_EQUAL(pool.TrimToSize(0), 2);
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolPackageTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+    std::list<CTransaction> removed;
+
+    // tx1 <- tx2 <- tx3, and an unrelated tx4
+    CMutableTransaction tx1 = CMutableTransaction();
+    tx1.vin.resize(1);
+    tx1.vin[0].scriptSig = CScript() << OP_1;
+    tx1.vout.resize(1);
+    tx1.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx1.vout[0].nValue = 10 * COIN;
+    CTxMemPoolEntry entry1 = entry.Fee(1000LL).FromTx(tx1);
+    pool.addUnchecked(tx1.GetHash(), entry1);
+
+    CMutableTransaction tx2 = CMutableTransaction();
+    tx2.vin.resize(1);
+    tx2.vin[0].prevout = COutPoint(tx1.GetHash(), 0);
+    tx2.vin[0].scriptSig = CScript() << OP_2;
+    tx2.vout.resize(1);
+    tx2.vout[0].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+    tx2.vout[0].nValue = 10 * COIN;
+    CTxMemPoolEntry entry2 = entry.Fee(5000LL).FromTx(tx2);
+    pool.addUnchecked(tx2.GetHash(), entry2);
+
+    CMutableTransaction tx3 = CMutableTransaction();
+    tx3.vin.resize(1);
+    tx3.vin[0].prevout = COutPoint(tx2.GetHash(), 0);
+    tx3.vin[0].scriptSig = CScript() << OP_3;
+    tx3.vout.resize(1);
+    tx3.vout[0].scriptPubKey = CScript() << OP_3 << OP_EQUAL;
+    tx3.vout[0].nValue = 10 * COIN;
+    CTxMemPoolEntry entry3 = entry.Fee(2000LL).FromTx(tx3);
+    pool.addUnchecked(tx3.GetHash(), entry3);
+
+    CMutableTransaction tx4 = CMutableTransaction();
+    tx4.vin.resize(1);
+    tx4.vin[0].scriptSig = CScript() << OP_4;
+    tx4.vout.resize(1);
+    tx4.vout[0].scriptPubKey = CScript() << OP_4 << OP_EQUAL;
+    tx4.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(tx4.GetHash(), entry.Fee(3000LL).FromTx(tx4));
+
+    uint64_t nSize1 = entry1.GetTxSize(), nSize2 = entry2.GetTxSize(), nSize3 = entry3.GetTxSize();
+    {
+        LOCK(pool.cs);
+        CTxMemPool::txiter it1 = pool.mapTx.find(tx1.GetHash());
+        CTxMemPool::txiter it2 = pool.mapTx.find(tx2.GetHash());
+        CTxMemPool::txiter it3 = pool.mapTx.find(tx3.GetHash());
+        CTxMemPool::txiter it4 = pool.mapTx.find(tx4.GetHash());
+
+        BOOST_CHECK_EQUAL(it1->GetCountWithDescendants(), 3);
+        BOOST_CHECK_EQUAL(it1->GetSizeWithDescendants(), nSize1 + nSize2 + nSize3);
+        BOOST_CHECK_EQUAL(it1->GetModFeesWithDescendants(), 8000LL);
+        BOOST_CHECK_EQUAL(it1->GetCountWithAncestors(), 1);
+        BOOST_CHECK_EQUAL(it2->GetCountWithDescendants(), 2);
+        BOOST_CHECK_EQUAL(it2->GetModFeesWithDescendants(), 7000LL);
+        BOOST_CHECK_EQUAL(it2->GetCountWithAncestors(), 2);
+        BOOST_CHECK_EQUAL(it2->GetModFeesWithAncestors(), 6000LL);
+        BOOST_CHECK_EQUAL(it3->GetCountWithAncestors(), 3);
+        BOOST_CHECK_EQUAL(it3->GetSizeWithAncestors(), nSize1 + nSize2 + nSize3);
+        BOOST_CHECK_EQUAL(it3->GetModFeesWithAncestors(), 8000LL);
+        BOOST_CHECK_EQUAL(it4->GetCountWithDescendants(), 1);
+        BOOST_CHECK_EQUAL(it4->GetCountWithAncestors(), 1);
+
+        // the child pays for its parent
+        BOOST_CHECK(it1->GetPackageFeeRate() == CFeeRate(8000LL, nSize1 + nSize2 + nSize3));
+        BOOST_CHECK(it4->GetPackageFeeRate() == CFeeRate(3000LL, it4->GetTxSize()));
+    }
+
+    // fee deltas reach the whole package
+    pool.PrioritiseTransaction(tx2.GetHash(), tx2.GetHash().ToString(), 0, 1000LL);
+    {
+        LOCK(pool.cs);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx1.GetHash())->GetModFeesWithDescendants(), 9000LL);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx3.GetHash())->GetModFeesWithAncestors(), 9000LL);
+    }
+
+    // removing the end of the chain
+    pool.remove(tx3, removed, false);
+    {
+        LOCK(pool.cs);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx1.GetHash())->GetCountWithDescendants(), 2);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx1.GetHash())->GetModFeesWithDescendants(), 7000LL);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx2.GetHash())->GetCountWithDescendants(), 1);
+    }
+
+    // removing the parent, as when it is mined, and adding it back, as on a reorg
+    pool.remove(tx1, removed, false);
+    {
+        LOCK(pool.cs);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx2.GetHash())->GetCountWithAncestors(), 1);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx2.GetHash())->GetModFeesWithAncestors(), 6000LL);
+    }
+    pool.addUnchecked(tx1.GetHash(), entry.Fee(1000LL).FromTx(tx1));
+    {
+        LOCK(pool.cs);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx1.GetHash())->GetCountWithDescendants(), 2);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx1.GetHash())->GetModFeesWithDescendants(), 7000LL);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx2.GetHash())->GetCountWithAncestors(), 2);
+        BOOST_CHECK_EQUAL(pool.mapTx.find(tx2.GetHash())->GetSizeWithAncestors(), nSize1 + nSize2);
+    }
+
+    // recursive removal takes the whole package
+    pool.remove(tx1, removed, true);
+    BOOST_CHECK_EQUAL(pool.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolChainLimitTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+
+    // a chain of 5 transactions, each spending the one before
+    std::vector<CMutableTransaction> chain;
+    for (int i = 0; i < 6; i++)
+    {
+        CMutableTransaction tx = CMutableTransaction();
+        tx.vin.resize(1);
+        if (i > 0)
+            tx.vin[0].prevout = COutPoint(chain.back().GetHash(), 0);
+        tx.vin[0].scriptSig = CScript() << i;
+        tx.vout.resize(2);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        tx.vout[1].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+        tx.vout[1].nValue = 10 * COIN;
+        chain.push_back(tx);
+        if (i < 5)
+            pool.addUnchecked(tx.GetHash(), entry.Fee(1000LL).FromTx(tx));
+    }
+    CTxMemPoolEntry next = entry.Fee(1000LL).FromTx(chain[5]);
+    uint64_t nTxSize = next.GetTxSize();
+
+    LOCK(pool.cs);
+    CTxMemPool::setEntries setAncestors;
+    std::string errString;
+    BOOST_CHECK(pool.CalculateMemPoolAncestors(next, setAncestors, 6, 6 * nTxSize, 6, 6 * nTxSize, errString));
+    BOOST_CHECK_EQUAL(setAncestors.size(), 5);
+
+    // one more ancestor than allowed
+    setAncestors.clear();
+    BOOST_CHECK(!pool.CalculateMemPoolAncestors(next, setAncestors, 5, 6 * nTxSize, 6, 6 * nTxSize, errString));
+    BOOST_CHECK_EQUAL(errString, "too many unconfirmed ancestors [limit: 5]");
+
+    // the first transaction would get a sixth descendant
+    setAncestors.clear();
+    BOOST_CHECK(!pool.CalculateMemPoolAncestors(next, setAncestors, 6, 6 * nTxSize, 5, 6 * nTxSize, errString));
+    BOOST_CHECK(errString.find("too many descendants") == 0);
+
+    // sizes count the new transaction too
+    setAncestors.clear();
+    BOOST_CHECK(!pool.CalculateMemPoolAncestors(next, setAncestors, 6, 6 * nTxSize - 1, 6, 6 * nTxSize, errString));
+    BOOST_CHECK_EQUAL(errString, strprintf("exceeds ancestor size limit [limit: %u]", 6 * nTxSize - 1));
+    setAncestors.clear();
+    BOOST_CHECK(!pool.CalculateMemPoolAncestors(next, setAncestors, 6, 6 * nTxSize, 6, 6 * nTxSize - 1, errString));
+    BOOST_CHECK(errString.find("exceeds descendant size limit") == 0);
+
+    // a sibling spending the second output of the last transaction only has the chain as ancestors
+    CMutableTransaction sibling = chain[5];
+    sibling.vin[0].prevout = COutPoint(chain[4].GetHash(), 1);
+    setAncestors.clear();
+    BOOST_CHECK(pool.CalculateMemPoolAncestors(entry.Fee(1000LL).FromTx(sibling), setAncestors, 6, 6 * nTxSize, 6, 6 * nTxSize, errString));
+    BOOST_CHECK_EQUAL(setAncestors.size(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolExportLimitTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+
+    // the last export and more unconfirmed transfers than the default ancestor limit
+    CMutableTransaction lastExport = CMutableTransaction();
+    lastExport.vin.resize(1);
+    lastExport.vout.resize(1);
+    lastExport.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    lastExport.vout[0].nValue = 0;
+    pool.addUnchecked(lastExport.GetHash(), entry.Fee(1000LL).FromTx(lastExport));
+
+    CMutableTransaction exportTx = CMutableTransaction();
+    exportTx.vin.push_back(CTxIn(COutPoint(lastExport.GetHash(), 0)));
+    for (int i = 0; i < DEFAULT_ANCESTOR_LIMIT + 5; i++)
+    {
+        CMutableTransaction transfer = CMutableTransaction();
+        transfer.vin.resize(1);
+        transfer.vin[0].scriptSig = CScript() << i;
+        transfer.vout.resize(1);
+        transfer.vout[0].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+        transfer.vout[0].nValue = COIN;
+        pool.addUnchecked(transfer.GetHash(), entry.Fee(1000LL).FromTx(transfer));
+        exportTx.vin.push_back(CTxIn(COutPoint(transfer.GetHash(), 0)));
+    }
+    exportTx.vout.resize(1);
+    exportTx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    exportTx.vout[0].nValue = 0;
+    CTxMemPoolEntry exportEntry = entry.Fee(1000LL).FromTx(exportTx);
+
+    LOCK(pool.cs);
+    std::string errString;
+    CReserveTransactionDescriptor txDesc;
+    BOOST_CHECK(!CheckMemPoolPackageLimits(pool, exportEntry, txDesc, errString));
+    BOOST_CHECK_EQUAL(errString, strprintf("too many unconfirmed parents [limit: %u]", DEFAULT_ANCESTOR_LIMIT));
+
+    // exports, imports and notarizations are accepted over any number of unconfirmed transactions
+    txDesc.flags = CReserveTransactionDescriptor::IS_VALID | CReserveTransactionDescriptor::IS_EXPORT;
+    BOOST_CHECK(CheckMemPoolPackageLimits(pool, exportEntry, txDesc, errString));
+    txDesc.flags = CReserveTransactionDescriptor::IS_VALID | CReserveTransactionDescriptor::IS_IMPORT;
+    BOOST_CHECK(CheckMemPoolPackageLimits(pool, exportEntry, txDesc, errString));
+    txDesc.flags = CReserveTransactionDescriptor::IS_VALID | CReserveTransactionDescriptor::IS_CHAIN_NOTARIZATION;
+    BOOST_CHECK(CheckMemPoolPackageLimits(pool, exportEntry, txDesc, errString));
+
+    // but not when the descriptor is rejected
+    txDesc.flags = CReserveTransactionDescriptor::IS_VALID | CReserveTransactionDescriptor::IS_REJECT | CReserveTransactionDescriptor::IS_EXPORT;
+    BOOST_CHECK(!CheckMemPoolPackageLimits(pool, exportEntry, txDesc, errString));
+
+    pool.addUnchecked(exportTx.GetHash(), exportEntry);
+    BOOST_CHECK_EQUAL(pool.size(), DEFAULT_ANCESTOR_LIMIT + 7);
+}
+
+// an address whose index entries land in the given shard
+static uint160 ShardAddress(unsigned char shard, unsigned char id)
+{
+    std::vector<unsigned char> bytes(20, 0);
+    bytes[0] = shard;
+    bytes[19] = id;
+    return uint160(bytes);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolShardedIndexTest)
+{
+    typedef CShardedMempoolIndex<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare, CMempoolAddressDeltaKeyShard> AddressIndex;
+    AddressIndex index;
+
+    // two transactions, each touching addresses in every shard, two of them in the same shard
+    std::vector<uint256> txids = {uint256S("0x01"), uint256S("0x02")};
+    std::vector<std::vector<CMempoolAddressDeltaKey>> txKeys(txids.size());
+    for (size_t t = 0; t < txids.size(); t++)
+    {
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> entries;
+        for (unsigned char shard = 0; shard < AddressIndex::SHARD_COUNT; shard++)
+        {
+            for (unsigned char id = 0; id < 2; id++)
+            {
+                CMempoolAddressDeltaKey key(CScript::P2PKH, ShardAddress(shard, id), txids[t], shard, 0);
+                entries.push_back(std::make_pair(key, CMempoolAddressDelta(t, (shard + 1) * COIN)));
+                txKeys[t].push_back(key);
+            }
+        }
+        index.insert(entries);
+    }
+
+    // a range read returns the entries of one address only, from both transactions
+    for (unsigned char shard = 0; shard < AddressIndex::SHARD_COUNT; shard++)
+    {
+        for (unsigned char id = 0; id < 2; id++)
+        {
+            uint160 address = ShardAddress(shard, id);
+            std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> results;
+            index.range(CMempoolAddressDeltaKey(CScript::P2PKH, address),
+                        [&address](const CMempoolAddressDeltaKey &key) { return key.addressBytes == address && key.type == CScript::P2PKH; },
+                        results);
+            BOOST_CHECK_EQUAL(results.size(), txids.size());
+            for (auto &result : results)
+            {
+                BOOST_CHECK(result.first.addressBytes == address);
+                BOOST_CHECK_EQUAL(result.second.amount, (shard + 1) * COIN);
+            }
+        }
+    }
+
+    CMempoolAddressDelta delta(-1, 0);
+    BOOST_CHECK(index.find(txKeys[0][5], delta));
+    BOOST_CHECK_EQUAL(delta.time, 0);
+
+    // removing the whole entry set of one transaction leaves the other's in every shard
+    index.erase(txKeys[0]);
+    for (auto &key : txKeys[0])
+    {
+        BOOST_CHECK(!index.find(key, delta));
+    }
+    for (auto &key : txKeys[1])
+    {
+        BOOST_CHECK(index.find(key, delta));
+        BOOST_CHECK_EQUAL(delta.time, 1);
+    }
+
+    index.clear();
+    for (auto &key : txKeys[1])
+    {
+        BOOST_CHECK(!index.find(key, delta));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MempoolAddressAndSpentIndexTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+    CCoinsView coinsDummy;
+    CCoinsViewCache view(&coinsDummy);
+
+    // a confirmed transaction paying addresses in different shards
+    CMutableTransaction funding = CMutableTransaction();
+    funding.vin.resize(1);
+    funding.vin[0].scriptSig = CScript() << OP_1;
+    for (unsigned char shard = 0; shard < 4; shard++)
+    {
+        funding.vout.push_back(CTxOut((shard + 1) * COIN, GetScriptForDestination(CKeyID(ShardAddress(shard * 5, 0)))));
+    }
+    view.ModifyCoins(funding.GetHash())->FromTx(funding, 1);
+
+    // a mempool transaction spending all of them to addresses in other shards
+    CMutableTransaction spend = CMutableTransaction();
+    for (unsigned int i = 0; i < funding.vout.size(); i++)
+    {
+        spend.vin.push_back(CTxIn(COutPoint(funding.GetHash(), i)));
+        spend.vout.push_back(CTxOut(COIN, GetScriptForDestination(CKeyID(ShardAddress(i * 5 + 1, 0)))));
+    }
+    CTxMemPoolEntry spendEntry = entry.Fee(0).FromTx(spend);
+    pool.addUnchecked(spend.GetHash(), spendEntry);
+    pool.addAddressIndex(spendEntry, view);
+    pool.addSpentIndex(spendEntry, view);
+
+    for (unsigned int i = 0; i < funding.vout.size(); i++)
+    {
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> results;
+        BOOST_CHECK(pool.getAddressIndex({{ShardAddress(i * 5, 0), CScript::P2PKH}, {ShardAddress(i * 5 + 1, 0), CScript::P2PKH}}, results));
+        BOOST_CHECK_EQUAL(results.size(), 2);
+        BOOST_CHECK_EQUAL(results[0].second.amount, -(CAmount)(i + 1) * COIN);
+        BOOST_CHECK(results[0].first.spending);
+        BOOST_CHECK_EQUAL(results[1].second.amount, COIN);
+        BOOST_CHECK(!results[1].first.spending);
+
+        CSpentIndexValue value;
+        BOOST_CHECK(pool.getSpentIndex(CSpentIndexKey(funding.GetHash(), i), value));
+        BOOST_CHECK(value.txid == spend.GetHash());
+        BOOST_CHECK_EQUAL(value.inputIndex, i);
+        BOOST_CHECK_EQUAL(value.satoshis, (CAmount)(i + 1) * COIN);
+    }
+
+    // all of the transaction's entries go when it is removed
+    BOOST_CHECK(pool.removeAddressIndex(spend.GetHash()));
+    BOOST_CHECK(pool.removeSpentIndex(spend.GetHash()));
+    for (unsigned int i = 0; i < funding.vout.size(); i++)
+    {
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> results;
+        BOOST_CHECK(pool.getAddressIndex({{ShardAddress(i * 5, 0), CScript::P2PKH}, {ShardAddress(i * 5 + 1, 0), CScript::P2PKH}}, results));
+        BOOST_CHECK(results.empty());
+
+        CSpentIndexValue value;
+        BOOST_CHECK(!pool.getSpentIndex(CSpentIndexKey(funding.GetHash(), i), value));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(RemoveWithoutBranchId) {
     CTxMemPool pool(CFeeRate(0));
     TestMemPoolEntryHelper entry;
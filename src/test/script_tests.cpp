@@ -5,11 +5,13 @@
 #include "data/script_invalid.json.h"
 #include "data/script_valid.json.h"
 
+#include "cc/CCinclude.h"
 #include "consensus/upgrades.h"
 #include "core_io.h"
 #include "key.h"
 #include "keystore.h"
 #include "main.h"
+#include "script/decodecache.h"
 #include "script/script.h"
 #include "script/script_error.h"
 #include "script/sign.h"
@@ -988,4 +990,34 @@ BOOST_AUTO_TEST_CASE(script_GetScriptAsm)
     BOOST_CHECK_EQUAL(derSig + "83 " + pubKey, ScriptToAsmStr(CScript() << ToByteVector(ParseHex(derSig + "83")) << vchPubKey));
 }
 
+BOOST_AUTO_TEST_CASE(block_script_cache)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CTokenOutput tokenOut(uint160(ParseHex("0102030405060708090a0b0c0d0e0f1011121314")), 5000);
+    CScript script = MakeMofNCCScript(CConditionObj<CTokenOutput>(EVAL_RESERVE_OUTPUT, std::vector<CTxDestination>({CTxDestination(key.GetPubKey().GetID())}), 1, &tokenOut));
+
+    COptCCParams uncached;
+    BOOST_CHECK(script.IsPayToCryptoCondition(uncached) && uncached.IsValid());
+    CCurrencyValueMap uncachedValue = script.ReserveOutValue();
+    BOOST_CHECK(uncachedValue == tokenOut.reserveValues);
+    BOOST_CHECK(CBlockScriptCache::GetActive() == nullptr);
+
+    {
+        CBlockScriptCache cache;
+        BOOST_CHECK(CBlockScriptCache::GetActive() == &cache);
+        for (int i = 0; i < 3; i++)
+        {
+            COptCCParams p;
+            BOOST_CHECK(script.IsPayToCryptoCondition(p));
+            BOOST_CHECK(p.AsVector() == uncached.AsVector());
+            BOOST_CHECK(script.ReserveOutValue() == uncachedValue);
+        }
+        // one parse and one reserve decode, with every later parse, including those inside ReserveOutValue, reused
+        BOOST_CHECK_EQUAL(cache.nDecoded, 2);
+        BOOST_CHECK_EQUAL(cache.nReused, 7);
+    }
+    BOOST_CHECK(CBlockScriptCache::GetActive() == nullptr);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,7 +4,9 @@
 
 #include "serialize.h"
 #include "streams.h"
+#include "addressindex.h"
 #include "hash.h"
+#include "pbaas/crosschainrpc.h"
 #include "test/test_bitcoin.h"
 #include "utilstrencodings.h"
 
@@ -417,4 +419,109 @@ BOOST_AUTO_TEST_CASE(class_methods)
     BOOST_CHECK(methodtest3 == methodtest4);
 }
 
+BOOST_AUTO_TEST_CASE(currency_value_map)
+{
+    // more currencies than are stored inline, inserted out of order
+    std::map<uint160, int64_t> reference;
+    CCurrencyValueMap values;
+    for (int i = 7; i >= 0; i--)
+    {
+        uint160 currencyID = Hash160(std::vector<unsigned char>(1, (unsigned char)i));
+        reference[currencyID] = i * 1000;
+        values.valueMap[currencyID] = i * 1000;
+    }
+
+    // serializes as the std::map it replaced, in both directions
+    CDataStream ssMap(SER_DISK, PROTOCOL_VERSION), ssFlat(SER_DISK, PROTOCOL_VERSION);
+    ssMap << reference;
+    ssFlat << values;
+    BOOST_CHECK(ssMap.str() == ssFlat.str());
+    BOOST_CHECK_EQUAL(GetSerializeSize(values, SER_DISK, PROTOCOL_VERSION), ssMap.size());
+
+    CCurrencyValueMap deserialized;
+    ssMap >> deserialized;
+    BOOST_CHECK(deserialized.valueMap == values.valueMap);
+    BOOST_CHECK(CCurrencyValueMap(reference).valueMap == values.valueMap);
+
+    auto previous = values.valueMap.begin();
+    for (auto it = previous + 1; it != values.valueMap.end(); previous = it++)
+    {
+        BOOST_CHECK(previous->first < it->first);
+    }
+
+    // arithmetic matches per currency arithmetic on the std::map
+    CCurrencyValueMap other;
+    uint160 newCurrencyID = Hash160(std::vector<unsigned char>(1, 100));
+    other.valueMap[newCurrencyID] = 5;
+    other.valueMap[reference.begin()->first] = 7;
+
+    CCurrencyValueMap sum = values + other;
+    BOOST_CHECK_EQUAL(sum.valueMap.size(), reference.size() + 1);
+    BOOST_CHECK_EQUAL(sum.valueMap[newCurrencyID], 5);
+    BOOST_CHECK_EQUAL(sum.valueMap[reference.begin()->first], reference.begin()->second + 7);
+    BOOST_CHECK((sum - other) == values);
+    BOOST_CHECK(values < sum);
+
+    BOOST_CHECK_EQUAL(sum.valueMap.erase(newCurrencyID), 1);
+    BOOST_CHECK_EQUAL(sum.valueMap.erase(newCurrencyID), 0);
+    BOOST_CHECK(!sum.valueMap.count(newCurrencyID));
+
+    // unsorted entries with duplicate keys read back as the std::map does, keeping the first of each key
+    std::vector<std::pair<uint160, int64_t>> unsorted;
+    for (int i = 0; i < 40; i++)
+    {
+        unsorted.push_back(std::make_pair(Hash160(std::vector<unsigned char>(1, (unsigned char)((i * 7) % 13))), (int64_t)i));
+    }
+    CDataStream ssUnsorted(SER_DISK, PROTOCOL_VERSION);
+    WriteCompactSize(ssUnsorted, unsorted.size());
+    for (auto &oneEntry : unsorted)
+    {
+        ssUnsorted << oneEntry;
+    }
+    CDataStream ssUnsortedCopy(ssUnsorted);
+    std::map<uint160, int64_t> mapFromUnsorted;
+    CCurrencyValueMap flatFromUnsorted;
+    ssUnsorted >> mapFromUnsorted;
+    ssUnsortedCopy >> flatFromUnsorted;
+    BOOST_CHECK_EQUAL(mapFromUnsorted.size(), 13);
+    BOOST_CHECK(CCurrencyValueMap(mapFromUnsorted).valueMap == flatFromUnsorted.valueMap);
+}
+
+BOOST_AUTO_TEST_CASE(address_unspent_value)
+{
+    CScript script = CScript() << OP_TRUE;
+    uint256 blockHash = uint256S("0x0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+
+    // an entry that records its confirming block reads back whole, also when followed by other data
+    CAddressUnspentValue confirmed(5 * COIN, script, 120, 100, blockHash), readConfirmed;
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << confirmed << (int32_t)77;
+    int32_t trailing = 0;
+    ss >> readConfirmed >> trailing;
+    BOOST_CHECK_EQUAL(readConfirmed.satoshis, 5 * COIN);
+    BOOST_CHECK(readConfirmed.script == script);
+    BOOST_CHECK_EQUAL(readConfirmed.blockHeight, 120);
+    BOOST_CHECK_EQUAL(readConfirmed.confirmedHeight, 100);
+    BOOST_CHECK(readConfirmed.confirmedBlockHash == blockHash);
+    BOOST_CHECK_EQUAL(trailing, 77);
+
+    // entries written before the confirming block was recorded have no marker
+    CDataStream ssOld(SER_DISK, PROTOCOL_VERSION);
+    ssOld << (CAmount)(3 * COIN) << *(CScriptBase*)(&script) << (int)90 << (int32_t)77;
+    size_t oldSize = ssOld.size() - sizeof(int32_t);
+    CAddressUnspentValue readOld;
+    ssOld >> readOld >> trailing;
+    BOOST_CHECK_EQUAL(readOld.satoshis, 3 * COIN);
+    BOOST_CHECK(readOld.script == script);
+    BOOST_CHECK_EQUAL(readOld.blockHeight, 90);
+    BOOST_CHECK_EQUAL(readOld.confirmedHeight, -1);
+    BOOST_CHECK(readOld.confirmedBlockHash.IsNull());
+    BOOST_CHECK_EQUAL(trailing, 77);
+
+    // and without a confirming block, the old format is still written
+    CDataStream ssUnconfirmed(SER_DISK, PROTOCOL_VERSION);
+    ssUnconfirmed << CAddressUnspentValue(3 * COIN, script, 90);
+    BOOST_CHECK_EQUAL(ssUnconfirmed.size(), oldSize);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
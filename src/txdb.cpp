@@ -32,11 +32,17 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 'S';
 static const char DB_BLOCKHASHINDEX = 'z';
 static const char DB_SPENTINDEX = 'p';
+static const char DB_IDENTITYUNSPENTINDEX = 'i';
+static const char DB_ADDRESSBALANCEINDEX = 'v';
+static const char DB_ADDRESSCURRENCYINDEX = 'U';
+static const char DB_COINSUPPLYINDEX = 'y';
+static const char DB_UTXOSTATSINDEX = 'o';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_BEST_SPROUT_ANCHOR = 'a';
 static const char DB_BEST_SAPLING_ANCHOR = 'z';
+static const char DB_BEST_ADDRESSBALANCE = 'V';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
@@ -46,10 +52,10 @@ static const char DB_LAST_BLOCK = 'l';
 //static const char DB_TIMESTAMPINDEX = 'T';
 //static const char DB_BLOCKHASHINDEX = 'h';
 
-CCoinsViewDB::CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / dbName, nCacheSize, fMemory, fWipe) {
+CCoinsViewDB::CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / dbName, nCacheSize, fMemory, fWipe, false, 64, dbName) {
 }
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe) 
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, false, 64, "chainstate")
 {
 }
 
@@ -203,7 +209,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins,
     return db.WriteBatch(batch);
 }
 
-CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, compression, maxOpenFiles) {
+CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, compression, maxOpenFiles, "blockindex") {
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -251,6 +257,9 @@ bool CCoinsViewDB::GetStats(CCoinsStats &stats) const {
                         ss << VARINT(i+1);
                         ss << out;
                         nTotalAmount += out.nValue;
+                        if (stats.fUTXOStats) {
+                            stats.utxoStats.AddOutput(COutPoint(key.second, i), out);
+                        }
                     }
                 }
                 stats.nSerializedSize += 32 + pcursor->GetValueSize();
@@ -319,6 +328,38 @@ bool CBlockTreeDB::UpdateSpentIndex(const std::vector<CSpentIndexDbEntry> &vect)
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ReadIdentityUnspentIndex(const uint160 &identityID, CIdentityUnspentIndexValue &value) {
+    return Read(make_pair(DB_IDENTITYUNSPENTINDEX, identityID), value);
+}
+
+bool CBlockTreeDB::UpdateIdentityUnspentIndex(const std::vector<CIdentityUnspentIndexDbEntry> &vect) {
+    CDBBatch batch(*this);
+    for (std::vector<CIdentityUnspentIndexDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(make_pair(DB_IDENTITYUNSPENTINDEX, it->first));
+        } else {
+            batch.Write(make_pair(DB_IDENTITYUNSPENTINDEX, it->first), it->second);
+        }
+    }
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadCoinSupplyIndex(const uint256 &blockHash, CCoinSupplyIndexValue &value) {
+    return Read(make_pair(DB_COINSUPPLYINDEX, blockHash), value);
+}
+
+bool CBlockTreeDB::WriteCoinSupplyIndex(const uint256 &blockHash, const CCoinSupplyIndexValue &value) {
+    return Write(make_pair(DB_COINSUPPLYINDEX, blockHash), value);
+}
+
+bool CBlockTreeDB::ReadUTXOStatsIndex(const uint256 &blockHash, CUTXOStatsIndexValue &value) {
+    return Read(make_pair(DB_UTXOSTATSINDEX, blockHash), value);
+}
+
+bool CBlockTreeDB::WriteUTXOStatsIndex(const uint256 &blockHash, const CUTXOStatsIndexValue &value) {
+    return Write(make_pair(DB_UTXOSTATSINDEX, blockHash), value);
+}
+
 bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<CAddressUnspentDbEntry> &vect) {
     CDBBatch batch(*this);
     for (std::vector<CAddressUnspentDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++) {
@@ -331,11 +372,15 @@ bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<CAddressUnspentDb
     return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &unspentOutputs)
+bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &unspentOutputs, CAddressIndexPage<CAddressUnspentKey> *pPage)
 {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    if (pPage && pPage->fStartKey) {
+        pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, pPage->startKey));
+    } else {
+        pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
 
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
@@ -347,6 +392,19 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::v
             CAddressUnspentKey indexKey = keyObj.second;
 
             if (chType == DB_ADDRESSUNSPENTINDEX && indexKey.hashBytes == addressHash) {
+                if (pPage) {
+                    if (pPage->offset) {
+                        pPage->offset--;
+                        pcursor->Next();
+                        continue;
+                    }
+                    if (!pPage->limit) {
+                        pPage->fMore = true;
+                        pPage->nextKey = indexKey;
+                        break;
+                    }
+                    pPage->limit--;
+                }
                 try {
                     CAddressUnspentValue nValue;
                     pcursor->GetValue(nValue);
@@ -365,6 +423,54 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::v
     return true;
 }
 
+bool CBlockTreeDB::UpdateAddressUnspentCurrencyIndex(const std::vector<CAddressUnspentCurrencyDbEntry> &vect) {
+    CDBBatch batch(*this);
+    for (std::vector<CAddressUnspentCurrencyDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(make_pair(DB_ADDRESSCURRENCYINDEX, it->first));
+        } else {
+            batch.Write(make_pair(DB_ADDRESSCURRENCYINDEX, it->first), it->second);
+        }
+    }
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadAddressUnspentCurrencyIndex(uint160 addressHash, int type, uint160 currencyID, std::vector<CAddressUnspentCurrencyDbEntry> &unspentOutputs)
+{
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(make_pair(DB_ADDRESSCURRENCYINDEX, CAddressCurrencyIteratorKey(type, addressHash, currencyID)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        try {
+            pair<char, CAddressUnspentCurrencyKey> keyObj;
+            pcursor->GetKey(keyObj);
+            char chType = keyObj.first;
+            CAddressUnspentCurrencyKey indexKey = keyObj.second;
+
+            if (chType == DB_ADDRESSCURRENCYINDEX &&
+                indexKey.type == type &&
+                indexKey.hashBytes == addressHash &&
+                indexKey.currencyID == currencyID) {
+                try {
+                    CAddressUnspentCurrencyValue nValue;
+                    pcursor->GetValue(nValue);
+                    unspentOutputs.push_back(make_pair(indexKey, nValue));
+                    pcursor->Next();
+                } catch (const std::exception& e) {
+                    return error("failed to get address unspent currency value");
+                }
+            } else {
+                break;
+            }
+        } catch (const std::exception& e) {
+            break;
+        }
+    }
+    return true;
+}
+
 bool CBlockTreeDB::WriteAddressIndex(const std::vector<CAddressIndexDbEntry> &vect) {
     CDBBatch batch(*this);
     for (std::vector<CAddressIndexDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++)
@@ -379,14 +485,38 @@ bool CBlockTreeDB::EraseAddressIndex(const std::vector<CAddressIndexDbEntry> &ve
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ReadAddressBalanceIndex(uint160 addressHash, int type, CAddressBalanceValue &value) {
+    return Read(make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(type, addressHash)), value);
+}
+
+bool CBlockTreeDB::ReadAddressBalanceBestBlock(uint256 &hashBlock) {
+    return Read(DB_BEST_ADDRESSBALANCE, hashBlock);
+}
+
+bool CBlockTreeDB::UpdateAddressBalanceIndex(const std::vector<CAddressBalanceDbEntry> &vect, const uint256 &hashBestBlock) {
+    CDBBatch batch(*this);
+    batch.Write(DB_BEST_ADDRESSBALANCE, hashBestBlock);
+    for (std::vector<CAddressBalanceDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(make_pair(DB_ADDRESSBALANCEINDEX, it->first));
+        } else {
+            batch.Write(make_pair(DB_ADDRESSBALANCEINDEX, it->first), it->second);
+        }
+    }
+    return WriteBatch(batch);
+}
+
 bool CBlockTreeDB::ReadAddressIndex(
         uint160 addressHash, int type,
         std::vector<CAddressIndexDbEntry> &addressIndex,
-        int start, int end)
+        int start, int end,
+        CAddressIndexPage<CAddressIndexKey> *pPage)
 {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    if (start > 0 && end > 0) {
+    if (pPage && pPage->fStartKey) {
+        pcursor->Seek(make_pair(DB_ADDRESSINDEX, pPage->startKey));
+    } else if (start > 0 && end > 0) {
         pcursor->Seek(make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
     } else {
         pcursor->Seek(make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
@@ -404,6 +534,19 @@ bool CBlockTreeDB::ReadAddressIndex(
                 if (end > 0 && indexKey.blockHeight > end) {
                     break;
                 }
+                if (pPage) {
+                    if (pPage->offset) {
+                        pPage->offset--;
+                        pcursor->Next();
+                        continue;
+                    }
+                    if (!pPage->limit) {
+                        pPage->fMore = true;
+                        pPage->nextKey = indexKey;
+                        break;
+                    }
+                    pPage->limit--;
+                }
                 try {
                     CAmount nValue;
                     pcursor->GetValue(nValue);
@@ -24,9 +24,16 @@ struct CAddressUnspentKey;
 struct CAddressUnspentValue;
 struct CAddressIndexKey;
 struct CAddressIndexIteratorKey;
+struct CAddressBalanceValue;
+struct CAddressUnspentCurrencyKey;
+struct CAddressUnspentCurrencyValue;
 struct CAddressIndexIteratorHeightKey;
+template <typename KeyType> struct CAddressIndexPage;
 struct CSpentIndexKey;
 struct CSpentIndexValue;
+struct CIdentityUnspentIndexValue;
+struct CCoinSupplyIndexValue;
+struct CUTXOStatsIndexValue;
 struct CTimestampIndexKey;
 struct CTimestampIndexIteratorKey;
 struct CTimestampBlockIndexKey;
@@ -35,6 +42,9 @@ struct CTimestampBlockIndexValue;
 typedef std::pair<CAddressUnspentKey, CAddressUnspentValue> CAddressUnspentDbEntry;
 typedef std::pair<CAddressIndexKey, CAmount> CAddressIndexDbEntry;
 typedef std::pair<CSpentIndexKey, CSpentIndexValue> CSpentIndexDbEntry;
+typedef std::pair<uint160, CIdentityUnspentIndexValue> CIdentityUnspentIndexDbEntry;
+typedef std::pair<CAddressIndexIteratorKey, CAddressBalanceValue> CAddressBalanceDbEntry;
+typedef std::pair<CAddressUnspentCurrencyKey, CAddressUnspentCurrencyValue> CAddressUnspentCurrencyDbEntry;
 
 class uint256;
 
@@ -116,11 +126,22 @@ public:
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &list);
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
     bool UpdateSpentIndex(const std::vector<CSpentIndexDbEntry> &vect);
+    bool ReadIdentityUnspentIndex(const uint160 &identityID, CIdentityUnspentIndexValue &value);
+    bool UpdateIdentityUnspentIndex(const std::vector<CIdentityUnspentIndexDbEntry> &vect);
+    bool ReadCoinSupplyIndex(const uint256 &blockHash, CCoinSupplyIndexValue &value);
+    bool WriteCoinSupplyIndex(const uint256 &blockHash, const CCoinSupplyIndexValue &value);
+    bool ReadUTXOStatsIndex(const uint256 &blockHash, CUTXOStatsIndexValue &value);
+    bool WriteUTXOStatsIndex(const uint256 &blockHash, const CUTXOStatsIndexValue &value);
     bool UpdateAddressUnspentIndex(const std::vector<CAddressUnspentDbEntry> &vect);
-    bool ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &vect);
+    bool ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &vect, CAddressIndexPage<CAddressUnspentKey> *pPage = nullptr);
+    bool UpdateAddressUnspentCurrencyIndex(const std::vector<CAddressUnspentCurrencyDbEntry> &vect);
+    bool ReadAddressUnspentCurrencyIndex(uint160 addressHash, int type, uint160 currencyID, std::vector<CAddressUnspentCurrencyDbEntry> &vect);
     bool WriteAddressIndex(const std::vector<CAddressIndexDbEntry> &vect);
     bool EraseAddressIndex(const std::vector<CAddressIndexDbEntry> &vect);
-    bool ReadAddressIndex(uint160 addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0);
+    bool ReadAddressIndex(uint160 addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0, CAddressIndexPage<CAddressIndexKey> *pPage = nullptr);
+    bool ReadAddressBalanceIndex(uint160 addressHash, int type, CAddressBalanceValue &value);
+    bool ReadAddressBalanceBestBlock(uint256 &hashBlock);
+    bool UpdateAddressBalanceIndex(const std::vector<CAddressBalanceDbEntry> &vect, const uint256 &hashBestBlock);
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &vect);
     bool WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts);
@@ -26,7 +26,9 @@ using namespace std;
 
 CTxMemPoolEntry::CTxMemPoolEntry():
     nFee(0), nTxSize(0), nModSize(0), nUsageSize(0), nTime(0), dPriority(0.0),
-    hadNoDependencies(false), spendsCoinbase(false), hasReserve(false), feeDelta(0)
+    hadNoDependencies(false), spendsCoinbase(false), hasReserve(false), feeDelta(0), nReserveDescHeight(0),
+    nCountWithDescendants(1), nSizeWithDescendants(0), nModFeesWithDescendants(0),
+    nCountWithAncestors(1), nSizeWithAncestors(0), nModFeesWithAncestors(0)
 {
     nHeight = MEMPOOL_HEIGHT;
 }
@@ -37,12 +39,16 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTransaction& _tx, const CAmount& _nFee,
                                  bool _spendsCoinbase, uint32_t _nBranchId, bool hasreserve, int64_t FeeDelta):
     tx(std::make_shared<CTransaction>(_tx)), nFee(_nFee), nTime(_nTime), dPriority(_dPriority), nHeight(_nHeight),
     hadNoDependencies(poolHasNoInputsOf), hasReserve(hasreserve),
-    spendsCoinbase(_spendsCoinbase), feeDelta(FeeDelta), nBranchId(_nBranchId)
+    spendsCoinbase(_spendsCoinbase), feeDelta(FeeDelta), nBranchId(_nBranchId), nReserveDescHeight(0)
 {
     nTxSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
     nModSize = _tx.CalculateModifiedSize(nTxSize);
     nUsageSize = RecursiveDynamicUsage(*tx) + memusage::DynamicUsage(tx);
     feeRate = CFeeRate(nFee, nTxSize);
+
+    nCountWithDescendants = nCountWithAncestors = 1;
+    nSizeWithDescendants = nSizeWithAncestors = nTxSize;
+    nModFeesWithDescendants = nModFeesWithAncestors = nFee + feeDelta;
 }
 
 CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry& other)
@@ -50,6 +56,49 @@ CTxMemPoolEntry::CTxMemPoolEntry(const CTxMemPoolEntry& other)
     *this = other;
 }
 
+void CTxMemPoolEntry::UpdateFeeDelta(int64_t FeeDelta)
+{
+    nModFeesWithDescendants += FeeDelta - feeDelta;
+    nModFeesWithAncestors += FeeDelta - feeDelta;
+    feeDelta = FeeDelta;
+}
+
+void CTxMemPoolEntry::UpdateDescendantState(int64_t modifySize, CAmount modifyFee, int64_t modifyCount)
+{
+    nSizeWithDescendants += modifySize;
+    assert(int64_t(nSizeWithDescendants) > 0);
+    nModFeesWithDescendants += modifyFee;
+    nCountWithDescendants += modifyCount;
+    assert(int64_t(nCountWithDescendants) > 0);
+}
+
+void CTxMemPoolEntry::UpdateAncestorState(int64_t modifySize, CAmount modifyFee, int64_t modifyCount)
+{
+    nSizeWithAncestors += modifySize;
+    assert(int64_t(nSizeWithAncestors) > 0);
+    nModFeesWithAncestors += modifyFee;
+    nCountWithAncestors += modifyCount;
+    assert(int64_t(nCountWithAncestors) > 0);
+}
+
+CFeeRate CTxMemPoolEntry::GetPackageFeeRate() const
+{
+    // compare by cross multiplication, so the result doesn't depend on rounding to a per kB rate
+    if ((double)nModFeesWithDescendants * nTxSize > (double)GetModifiedFee() * nSizeWithDescendants)
+    {
+        return CFeeRate(nModFeesWithDescendants, nSizeWithDescendants);
+    }
+    return CFeeRate(GetModifiedFee(), nTxSize);
+}
+
+void CTxMemPoolEntry::SetReserveDescriptor(const CReserveTransactionDescriptor &desc, int32_t descHeight, const uint256 &hashPrevBlock)
+{
+    reserveDesc = desc;
+    reserveDesc.ptx = tx.get();
+    nReserveDescHeight = descHeight;
+    hashReserveDescPrev = hashPrevBlock;
+}
+
 double
 CTxMemPoolEntry::GetPriority(unsigned int currentHeight) const
 {
@@ -130,7 +179,31 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     // all the appropriate checks.
     LOCK(cs);
     mapTx.insert(entry);
-    const CTransaction& tx = mapTx.find(hash)->GetTx();
+    indexed_transaction_set::iterator newit = mapTx.find(hash);
+    std::map<uint256, std::pair<double, CAmount> >::const_iterator deltaIt = mapDeltas.find(hash);
+    if (deltaIt != mapDeltas.end() && deltaIt->second.second) {
+        mapTx.modify(newit, update_fee_delta(deltaIt->second.second));
+    }
+    const CTransaction& tx = newit->GetTx();
+
+    // link to in-mempool parents, and to children already in the mempool, which can only
+    // be there when a disconnected block's transactions are added back
+    mapLinks.insert(make_pair(newit, TxLinks()));
+    for (unsigned int i = 0; i < tx.vin.size(); i++) {
+        indexed_transaction_set::iterator pit = mapTx.find(tx.vin[i].prevout.hash);
+        if (pit != mapTx.end())
+            UpdateLink(pit, newit, true);
+    }
+    for (unsigned int i = 0; i < tx.vout.size(); i++) {
+        std::map<COutPoint, CInPoint>::iterator nit = mapNextTx.find(COutPoint(hash, i));
+        if (nit == mapNextTx.end())
+            continue;
+        indexed_transaction_set::iterator cit = mapTx.find(nit->second.ptx->GetHash());
+        if (cit != mapTx.end())
+            UpdateLink(newit, cit, true);
+    }
+    UpdateForAdd(newit);
+
     mapRecentlyAddedTx[tx.GetHash()] = &tx;
     nRecentlyAddedSequence += 1;
     if (!tx.IsCoinImport()) {
@@ -153,11 +226,210 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     return true;
 }
 
+void CTxMemPool::UpdateLink(txiter parent, txiter child, bool add)
+{
+    setEntries &children = mapLinks[parent].children;
+    setEntries &parents = mapLinks[child].parents;
+    if (add) {
+        if (children.insert(child).second)
+            cachedInnerUsage += memusage::IncrementalDynamicUsage(children);
+        if (parents.insert(parent).second)
+            cachedInnerUsage += memusage::IncrementalDynamicUsage(parents);
+    } else {
+        if (children.erase(child))
+            cachedInnerUsage -= memusage::IncrementalDynamicUsage(children);
+        if (parents.erase(parent))
+            cachedInnerUsage -= memusage::IncrementalDynamicUsage(parents);
+    }
+}
+
+void CTxMemPool::CalculateAncestors(txiter it, setEntries &setAncestors) const
+{
+    std::vector<txiter> stage(1, it);
+    while (!stage.empty()) {
+        txiter next = stage.back();
+        stage.pop_back();
+        txlinksMap::const_iterator lit = mapLinks.find(next);
+        if (lit == mapLinks.end())
+            continue;
+        for (txiter parent : lit->second.parents) {
+            if (setAncestors.insert(parent).second)
+                stage.push_back(parent);
+        }
+    }
+}
+
+void CTxMemPool::CalculateDescendants(txiter it, setEntries &setDescendants) const
+{
+    std::vector<txiter> stage(1, it);
+    while (!stage.empty()) {
+        txiter next = stage.back();
+        stage.pop_back();
+        txlinksMap::const_iterator lit = mapLinks.find(next);
+        if (lit == mapLinks.end())
+            continue;
+        for (txiter child : lit->second.children) {
+            if (setDescendants.insert(child).second)
+                stage.push_back(child);
+        }
+    }
+}
+
+bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntries &setAncestors,
+                                           uint64_t limitAncestorCount, uint64_t limitAncestorSize,
+                                           uint64_t limitDescendantCount, uint64_t limitDescendantSize,
+                                           std::string &errString) const
+{
+    AssertLockHeld(cs);
+    const CTransaction &tx = entry.GetTx();
+    setEntries parentHashes;
+    for (unsigned int i = 0; i < tx.vin.size(); i++) {
+        indexed_transaction_set::const_iterator piter = mapTx.find(tx.vin[i].prevout.hash);
+        if (piter != mapTx.end()) {
+            parentHashes.insert(piter);
+            if (parentHashes.size() + 1 > limitAncestorCount) {
+                errString = strprintf("too many unconfirmed parents [limit: %u]", limitAncestorCount);
+                return false;
+            }
+        }
+    }
+
+    uint64_t totalSizeWithAncestors = entry.GetTxSize();
+    while (!parentHashes.empty()) {
+        txiter stageit = *parentHashes.begin();
+        setAncestors.insert(stageit);
+        parentHashes.erase(stageit);
+        totalSizeWithAncestors += stageit->GetTxSize();
+
+        if (stageit->GetSizeWithDescendants() + entry.GetTxSize() > limitDescendantSize) {
+            errString = strprintf("exceeds descendant size limit for tx %s [limit: %u]", stageit->GetTx().GetHash().ToString(), limitDescendantSize);
+            return false;
+        } else if (stageit->GetCountWithDescendants() + 1 > limitDescendantCount) {
+            errString = strprintf("too many descendants for tx %s [limit: %u]", stageit->GetTx().GetHash().ToString(), limitDescendantCount);
+            return false;
+        } else if (totalSizeWithAncestors > limitAncestorSize) {
+            errString = strprintf("exceeds ancestor size limit [limit: %u]", limitAncestorSize);
+            return false;
+        }
+
+        txlinksMap::const_iterator lit = mapLinks.find(stageit);
+        if (lit == mapLinks.end())
+            continue;
+        for (txiter parent : lit->second.parents) {
+            if (!setAncestors.count(parent)) {
+                parentHashes.insert(parent);
+            }
+            if (parentHashes.size() + setAncestors.size() + 1 > limitAncestorCount) {
+                errString = strprintf("too many unconfirmed ancestors [limit: %u]", limitAncestorCount);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void CTxMemPool::RecalculatePackageState(txiter it)
+{
+    setEntries setAncestors, setDescendants;
+    CalculateAncestors(it, setAncestors);
+    CalculateDescendants(it, setDescendants);
+
+    int64_t nSize = it->GetTxSize();
+    CAmount nFees = it->GetModifiedFee();
+    for (txiter ancestor : setAncestors) {
+        nSize += ancestor->GetTxSize();
+        nFees += ancestor->GetModifiedFee();
+    }
+    mapTx.modify(it, update_ancestor_state(nSize - it->GetSizeWithAncestors(),
+                                           nFees - it->GetModFeesWithAncestors(),
+                                           setAncestors.size() + 1 - it->GetCountWithAncestors()));
+
+    nSize = it->GetTxSize();
+    nFees = it->GetModifiedFee();
+    for (txiter descendant : setDescendants) {
+        nSize += descendant->GetTxSize();
+        nFees += descendant->GetModifiedFee();
+    }
+    mapTx.modify(it, update_descendant_state(nSize - it->GetSizeWithDescendants(),
+                                             nFees - it->GetModFeesWithDescendants(),
+                                             setDescendants.size() + 1 - it->GetCountWithDescendants()));
+}
+
+void CTxMemPool::UpdateForAdd(txiter it)
+{
+    setEntries setAncestors, setDescendants;
+    CalculateAncestors(it, setAncestors);
+    CalculateDescendants(it, setDescendants);
+
+    if (setDescendants.empty()) {
+        // the usual case, a new transaction at the end of its chains
+        int64_t nSize = it->GetTxSize();
+        CAmount nFees = it->GetModifiedFee();
+        int64_t nAncestorSize = 0;
+        CAmount nAncestorFees = 0;
+        for (txiter ancestor : setAncestors) {
+            mapTx.modify(ancestor, update_descendant_state(nSize, nFees, 1));
+            nAncestorSize += ancestor->GetTxSize();
+            nAncestorFees += ancestor->GetModifiedFee();
+        }
+        mapTx.modify(it, update_ancestor_state(nAncestorSize, nAncestorFees, setAncestors.size()));
+    } else {
+        // the transaction joins chains already in the mempool, so everything
+        // it connects has its package state recomputed
+        RecalculatePackageState(it);
+        for (txiter ancestor : setAncestors)
+            RecalculatePackageState(ancestor);
+        for (txiter descendant : setDescendants)
+            RecalculatePackageState(descendant);
+    }
+}
+
+void CTxMemPool::UpdateForRemove(txiter it)
+{
+    setEntries setAncestors, setDescendants;
+    CalculateAncestors(it, setAncestors);
+    CalculateDescendants(it, setDescendants);
+
+    int64_t nSize = it->GetTxSize();
+    CAmount nFees = it->GetModifiedFee();
+    for (txiter ancestor : setAncestors)
+        mapTx.modify(ancestor, update_descendant_state(-nSize, -nFees, -1));
+    for (txiter descendant : setDescendants)
+        mapTx.modify(descendant, update_ancestor_state(-nSize, -nFees, -1));
+
+    txlinksMap::iterator lit = mapLinks.find(it);
+    if (lit == mapLinks.end())
+        return;
+    const TxLinks links = lit->second;
+    for (txiter parent : links.parents)
+        UpdateLink(parent, it, false);
+    for (txiter child : links.children)
+        UpdateLink(it, child, false);
+    mapLinks.erase(it);
+}
+
+void CTxMemPool::UpdateModifiedFee(txiter it, CAmount newFeeDelta)
+{
+    CAmount nChange = newFeeDelta - (it->GetModifiedFee() - it->GetFee());
+    mapTx.modify(it, update_fee_delta(newFeeDelta));
+    if (nChange == 0)
+        return;
+
+    setEntries setAncestors, setDescendants;
+    CalculateAncestors(it, setAncestors);
+    CalculateDescendants(it, setDescendants);
+    for (txiter ancestor : setAncestors)
+        mapTx.modify(ancestor, update_descendant_state(0, nChange, 0));
+    for (txiter descendant : setDescendants)
+        mapTx.modify(descendant, update_ancestor_state(0, nChange, 0));
+}
+
 void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewCache &view)
 {
     LOCK(cs);
     const CTransaction& tx = entry.GetTx();
     std::vector<CMempoolAddressDeltaKey> inserted;
+    std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> entries;
 
     uint256 txhash = tx.GetHash();
     if (!tx.IsCoinBase())
@@ -190,7 +462,7 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
                         {
                             CMempoolAddressDeltaKey key(AddressTypeFromDest(dest), destID, txhash, j, 1);
                             CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-                            mapAddress.insert(make_pair(key, delta));
+                            entries.push_back(make_pair(key, delta));
                             inserted.push_back(key);
                         }
                     }
@@ -204,7 +476,7 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
 
                 CMempoolAddressDeltaKey key(type, prevout.scriptPubKey.AddressHash(), txhash, j, 1);
                 CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-                mapAddress.insert(make_pair(key, delta));
+                entries.push_back(make_pair(key, delta));
                 inserted.push_back(key);
             }
         }
@@ -237,7 +509,7 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
                     if (!(dest.which() == COptCCParams::ADDRTYPE_INDEX && heightOffsets.count(destID) && heightOffsets[destID] > nHeight))
                     {
                         CMempoolAddressDeltaKey key(AddressTypeFromDest(dest), GetDestinationID(dest), txhash, j, 0);
-                        mapAddress.insert(make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
+                        entries.push_back(make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
                         inserted.push_back(key);
                     }
                 }
@@ -250,22 +522,23 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
                 continue;
 
             CMempoolAddressDeltaKey key(type, out.scriptPubKey.AddressHash(), txhash, j, 0);
-            mapAddress.insert(make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
+            entries.push_back(make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
             inserted.push_back(key);
         }
     }
+    mapAddress.insert(entries);
     mapAddressInserted.insert(make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getAddressIndex(const std::vector<std::pair<uint160, int> > &addresses, std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results)
 {
-    LOCK(cs);
+    // no mempool lock, each address is read under its shard's lock
     for (std::vector<std::pair<uint160, int> >::const_iterator it = addresses.begin(); it != addresses.end(); it++) {
-        auto ait = mapAddress.lower_bound(CMempoolAddressDeltaKey((*it).second, (*it).first));
-        while (ait != mapAddress.end() && (*ait).first.addressBytes == (*it).first && (*ait).first.type == (*it).second) {
-            results.push_back(*ait);
-            ait++;
-        }
+        const uint160 &addressBytes = (*it).first;
+        int type = (*it).second;
+        mapAddress.range(CMempoolAddressDeltaKey(type, addressBytes),
+                         [&addressBytes, type](const CMempoolAddressDeltaKey &key) { return key.addressBytes == addressBytes && key.type == type; },
+                         results);
     }
     return true;
 }
@@ -311,10 +584,7 @@ bool CTxMemPool::removeAddressIndex(const uint256 txhash)
     auto it = mapAddressInserted.find(txhash);
 
     if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
-        }
+        mapAddress.erase((*it).second);
         mapAddressInserted.erase(it);
     }
 
@@ -327,6 +597,7 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
     const CTransaction& tx = entry.GetTx();
     uint256 txhash = tx.GetHash();
     std::vector<CSpentIndexKey> inserted;
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue>> entries;
 
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
         const CTxIn input = tx.vin[j];
@@ -335,21 +606,16 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
         CSpentIndexValue value = CSpentIndexValue(txhash, j, -1, prevout.nValue,
             prevout.scriptPubKey.GetType(),
             prevout.scriptPubKey.AddressHash());
-        mapSpent.insert(make_pair(key, value));
+        entries.push_back(make_pair(key, value));
         inserted.push_back(key);
     }
+    mapSpent.insert(entries);
     mapSpentInserted.insert(make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getSpentIndex(const CSpentIndexKey &key, CSpentIndexValue &value)
 {
-    LOCK(cs);
-    std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare>::iterator it = mapSpent.find(key);
-    if (it != mapSpent.end()) {
-        value = it->second;
-        return true;
-    }
-    return false;
+    return mapSpent.find(key, value);
 }
 
 bool CTxMemPool::removeSpentIndex(const uint256 txhash)
@@ -358,10 +624,7 @@ bool CTxMemPool::removeSpentIndex(const uint256 txhash)
     auto it = mapSpentInserted.find(txhash);
 
     if (it != mapSpentInserted.end()) {
-        std::vector<CSpentIndexKey> keys = (*it).second;
-        for (std::vector<CSpentIndexKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapSpent.erase(*mit);
-        }
+        mapSpent.erase((*it).second);
         mapSpentInserted.erase(it);
     }
 
@@ -414,16 +677,18 @@ void CTxMemPool::remove(const CTransaction &origTx, std::list<CTransaction>& rem
                 mapSaplingNullifiers.erase(spendDescription.nullifier);
             }
             removed.push_back(tx);
-            totalTxSize -= mapTx.find(hash)->GetTxSize();
-            cachedInnerUsage -= mapTx.find(hash)->DynamicMemoryUsage();
-            mapTx.erase(hash);
+            indexed_transaction_set::iterator it = mapTx.find(hash);
+            UpdateForRemove(it);
+            totalTxSize -= it->GetTxSize();
+            cachedInnerUsage -= it->DynamicMemoryUsage();
+            mapTx.erase(it);
             nTransactionsUpdated++;
             minerPolicyEstimator->removeTx(hash);
             if (fAddressIndex)
                 removeAddressIndex(hash);
             if (fSpentIndex)
                 removeSpentIndex(hash);
-            ClearPrioritisation(tx.GetHash());
+            ClearPrioritisation(hash);
         }
     }
 }
@@ -841,11 +1106,43 @@ void CTxMemPool::removeWithoutBranchId(uint32_t nMemPoolBranchId)
     }
 }
 
+size_t CTxMemPool::TrimToSize(size_t sizelimit, std::vector<uint256>* pvNoSpendsRemaining)
+{
+    LOCK(cs);
+    size_t nEvicted = 0;
+
+    while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
+        // the last entry by score has the lowest fee rate, counting any reserve fees it pays
+        CTransaction tx = mapTx.get<2>().rbegin()->GetTx();
+        std::list<CTransaction> removed;
+        remove(tx, removed, true);
+        nEvicted += removed.size();
+
+        if (pvNoSpendsRemaining) {
+            for (const CTransaction& oneTx : removed) {
+                for (const CTxIn& txin : oneTx.vin) {
+                    if (!mapTx.count(txin.prevout.hash)) {
+                        pvNoSpendsRemaining->push_back(txin.prevout.hash);
+                    }
+                }
+            }
+        }
+    }
+
+    nEvictedTx += nEvicted;
+    return nEvicted;
+}
+
 void CTxMemPool::clear()
 {
     LOCK(cs);
+    mapLinks.clear();
     mapTx.clear();
     mapNextTx.clear();
+    mapAddress.clear();
+    mapAddressInserted.clear();
+    mapSpent.clear();
+    mapSpentInserted.clear();
     totalTxSize = 0;
     cachedInnerUsage = 0;
     ++nTransactionsUpdated;
@@ -875,6 +1172,7 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
         innerUsage += it->DynamicMemoryUsage();
         const CTransaction& tx = it->GetTx();
         bool fDependsWait = false;
+        setEntries setParentCheck;
         BOOST_FOREACH(const CTxIn &txin, tx.vin) {
             // Check that every mempool transaction's inputs refer to available coins, or other mempool tx's.
             indexed_transaction_set::const_iterator it2 = mapTx.find(txin.prevout.hash);
@@ -882,6 +1180,7 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
                 const CTransaction& tx2 = it2->GetTx();
                 assert(tx2.vout.size() > txin.prevout.n && !tx2.vout[txin.prevout.n].IsNull());
                 fDependsWait = true;
+                setParentCheck.insert(it2);
             } else {
                 const CCoins* coins = pcoins->AccessCoins(txin.prevout.hash);
                 assert(coins && coins->IsAvailable(txin.prevout.n));
@@ -894,6 +1193,34 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
             i++;
         }
 
+        // Check the links to other entries and the package statistics derived from them
+        txlinksMap::const_iterator lit = mapLinks.find(it);
+        assert(lit != mapLinks.end());
+        assert(setParentCheck == lit->second.parents);
+        innerUsage += memusage::DynamicUsage(lit->second.parents) + memusage::DynamicUsage(lit->second.children);
+
+        setEntries setAncestors, setDescendants;
+        CalculateAncestors(it, setAncestors);
+        CalculateDescendants(it, setDescendants);
+        uint64_t nSizeCheck = it->GetTxSize();
+        CAmount nFeesCheck = it->GetModifiedFee();
+        for (txiter ancestor : setAncestors) {
+            nSizeCheck += ancestor->GetTxSize();
+            nFeesCheck += ancestor->GetModifiedFee();
+        }
+        assert(it->GetCountWithAncestors() == setAncestors.size() + 1);
+        assert(it->GetSizeWithAncestors() == nSizeCheck);
+        assert(it->GetModFeesWithAncestors() == nFeesCheck);
+        nSizeCheck = it->GetTxSize();
+        nFeesCheck = it->GetModifiedFee();
+        for (txiter descendant : setDescendants) {
+            nSizeCheck += descendant->GetTxSize();
+            nFeesCheck += descendant->GetModifiedFee();
+        }
+        assert(it->GetCountWithDescendants() == setDescendants.size() + 1);
+        assert(it->GetSizeWithDescendants() == nSizeCheck);
+        assert(it->GetModFeesWithDescendants() == nFeesCheck);
+
         boost::unordered_map<uint256, SproutMerkleTree, CCoinsKeyHasher> intermediates;
 
         BOOST_FOREACH(const JSDescription &joinsplit, tx.vJoinSplit) {
@@ -962,6 +1289,7 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
     checkNullifiers(SPROUT);
     checkNullifiers(SAPLING);
 
+    assert(mapLinks.size() == mapTx.size());
     assert(totalTxSize == checkTotal);
     assert(innerUsage == cachedInnerUsage);
 }
@@ -1078,6 +1406,11 @@ void CTxMemPool::PrioritiseTransaction(const uint256 &hash, const string strHash
         std::pair<double, CAmount> &deltas = mapDeltas[hash];
         deltas.first += dPriorityDelta;
         deltas.second += nFeeDelta;
+        // keep the eviction order in step with the modified fee
+        indexed_transaction_set::iterator it = mapTx.find(hash);
+        if (it != mapTx.end()) {
+            UpdateModifiedFee(it, deltas.second);
+        }
     }
     if (fDebug)
     {
@@ -1100,17 +1433,14 @@ void CTxMemPool::ClearPrioritisation(const uint256 hash)
 {
     LOCK(cs);
     mapDeltas.erase(hash);
-    mapReserveTransactions.erase(hash);
 }
 
 bool CTxMemPool::PrioritiseReserveTransaction(const CReserveTransactionDescriptor &txDesc)
 {
     LOCK(cs);
     uint256 hash = txDesc.ptx->GetHash();
-    auto it = mapReserveTransactions.find(hash);
     if (txDesc.IsValid())
     {
-        mapReserveTransactions[hash] = txDesc;
         CAmount feeDelta = txDesc.NativeFees();
         if (!IsVerusActive())
         {
@@ -1130,22 +1460,28 @@ bool CTxMemPool::PrioritiseReserveTransaction(const CReserveTransactionDescripto
 bool CTxMemPool::IsKnownReserveTransaction(const uint256 &hash, CReserveTransactionDescriptor &txDesc)
 {
     LOCK(cs);
-    auto it = mapReserveTransactions.find(hash);
-    if (it != mapReserveTransactions.end() && it->second.IsValid())
+    indexed_transaction_set::const_iterator i = mapTx.find(hash);
+    if (i != mapTx.end() && i->GetReserveDescriptor().IsValid())
     {
-        // refresh transaction from mempool or delete it if not found (we may not need this at all)
-        indexed_transaction_set::const_iterator i = mapTx.find(hash);
-        if (i == mapTx.end())
-        {
-            ClearPrioritisation(hash);
-        }
-        else
-        {
-            it->second.ptx = &(i->GetTx());
+        txDesc = i->GetReserveDescriptor();
+        txDesc.ptx = &(i->GetTx());
+        return true;
+    }
+    return false;
+}
 
-            txDesc = it->second;
-            return true;
-        }
+bool CTxMemPool::GetReserveDescriptor(const uint256 &hash, CReserveTransactionDescriptor &txDesc, int32_t nHeight, const uint256 &hashPrevBlock)
+{
+    LOCK(cs);
+    indexed_transaction_set::const_iterator i = mapTx.find(hash);
+    if (i != mapTx.end() &&
+        i->GetReserveDescriptor().IsValid() &&
+        i->GetReserveDescriptorHeight() == nHeight &&
+        i->GetReserveDescriptorPrevBlock() == hashPrevBlock)
+    {
+        txDesc = i->GetReserveDescriptor();
+        txDesc.ptx = &(i->GetTx());
+        return true;
     }
     return false;
 }
@@ -1238,6 +1574,6 @@ bool CCoinsViewMemPool::HaveCoins(const uint256 &txid) const {
 
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 6 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 6 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapDeltas) + cachedInnerUsage;
+    // Estimate the overhead of mapTx to be 9 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 9 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapDeltas) + cachedInnerUsage;
 }
@@ -12,6 +12,7 @@
 #include "spentindex.h"
 #include "amount.h"
 #include "coins.h"
+#include "crypto/common.h"
 #include "primitives/transaction.h"
 #include "sync.h"
 #include "addressindex.h"
@@ -20,6 +21,7 @@
 #undef foreach
 #include "boost/multi_index_container.hpp"
 #include "boost/multi_index/ordered_index.hpp"
+#include "boost/thread/shared_mutex.hpp"
 
 #include "pbaas/reserves.h"
 
@@ -60,6 +62,18 @@ private:
     bool hasReserve; //! keep track of transactions that hold reserve currency
     int64_t feeDelta;          //!< Used for determining the priority of the transaction for mining in a block
     uint32_t nBranchId; //! Branch ID this transaction is known to commit to, cached for efficiency
+    CReserveTransactionDescriptor reserveDesc; //! Reserve descriptor computed on acceptance, if any
+    int32_t nReserveDescHeight; //! ... the block height it was computed for
+    uint256 hashReserveDescPrev; //! ... and the block it was computed on top of
+
+    // Statistics of the in-mempool packages this transaction belongs to, maintained by
+    // CTxMemPool as transactions enter and leave. Fees are modified fees, including any delta.
+    uint64_t nCountWithDescendants;  //! number of descendant transactions, including this one
+    uint64_t nSizeWithDescendants;   //! ... and their total size
+    CAmount nModFeesWithDescendants; //! ... and total modified fees
+    uint64_t nCountWithAncestors;    //! number of ancestor transactions, including this one
+    uint64_t nSizeWithAncestors;     //! ... and their total size
+    CAmount nModFeesWithAncestors;   //! ... and total modified fees
 
 public:
     CTxMemPoolEntry(const CTransaction& _tx, const CAmount& _nFee,
@@ -72,7 +86,7 @@ public:
     std::shared_ptr<const CTransaction> GetSharedTx() const { return this->tx; }
     double GetPriority(unsigned int currentHeight) const;
     CAmount GetFee() const { return nFee; }
-    void UpdateFeeDelta(int64_t FeeDelta) { feeDelta = FeeDelta; }
+    void UpdateFeeDelta(int64_t FeeDelta);
     int64_t GetModifiedFee() const { return nFee + feeDelta; }
     CFeeRate GetFeeRate() const { return feeRate; }
     size_t GetTxSize() const { return nTxSize; }
@@ -83,6 +97,52 @@ public:
 
     bool GetSpendsCoinbase() const { return spendsCoinbase; }
     uint32_t GetValidatedBranchId() const { return nBranchId; }
+
+    void SetReserveDescriptor(const CReserveTransactionDescriptor &desc, int32_t descHeight, const uint256 &hashPrevBlock);
+    const CReserveTransactionDescriptor &GetReserveDescriptor() const { return reserveDesc; }
+    int32_t GetReserveDescriptorHeight() const { return nReserveDescHeight; }
+    const uint256 &GetReserveDescriptorPrevBlock() const { return hashReserveDescPrev; }
+
+    // Adjust the package statistics as related transactions enter or leave the mempool
+    void UpdateDescendantState(int64_t modifySize, CAmount modifyFee, int64_t modifyCount);
+    void UpdateAncestorState(int64_t modifySize, CAmount modifyFee, int64_t modifyCount);
+
+    uint64_t GetCountWithDescendants() const { return nCountWithDescendants; }
+    uint64_t GetSizeWithDescendants() const { return nSizeWithDescendants; }
+    CAmount GetModFeesWithDescendants() const { return nModFeesWithDescendants; }
+    uint64_t GetCountWithAncestors() const { return nCountWithAncestors; }
+    uint64_t GetSizeWithAncestors() const { return nSizeWithAncestors; }
+    CAmount GetModFeesWithAncestors() const { return nModFeesWithAncestors; }
+
+    // the higher of this transaction's own modified fee rate and that of it with all of its descendants,
+    // which lets a high fee child pull its parents into a block
+    CFeeRate GetPackageFeeRate() const;
+};
+
+struct update_descendant_state
+{
+    update_descendant_state(int64_t _modifySize, CAmount _modifyFee, int64_t _modifyCount) :
+        modifySize(_modifySize), modifyFee(_modifyFee), modifyCount(_modifyCount) { }
+
+    void operator() (CTxMemPoolEntry &e) { e.UpdateDescendantState(modifySize, modifyFee, modifyCount); }
+
+private:
+    int64_t modifySize;
+    CAmount modifyFee;
+    int64_t modifyCount;
+};
+
+struct update_ancestor_state
+{
+    update_ancestor_state(int64_t _modifySize, CAmount _modifyFee, int64_t _modifyCount) :
+        modifySize(_modifySize), modifyFee(_modifyFee), modifyCount(_modifyCount) { }
+
+    void operator() (CTxMemPoolEntry &e) { e.UpdateAncestorState(modifySize, modifyFee, modifyCount); }
+
+private:
+    int64_t modifySize;
+    CAmount modifyFee;
+    int64_t modifyCount;
 };
 
 struct update_fee_delta
@@ -108,7 +168,7 @@ struct mempoolentry_txid
 class CompareTxMemPoolEntryByFee
 {
 public:
-    bool operator()(const CTxMemPoolEntry& a, const CTxMemPoolEntry& b)
+    bool operator()(const CTxMemPoolEntry& a, const CTxMemPoolEntry& b) const
     {
         if (a.GetFeeRate() == b.GetFeeRate())
             return a.GetTime() < b.GetTime();
@@ -150,6 +210,120 @@ public:
     size_t DynamicMemoryUsage() const { return 0; }
 };
 
+/**
+ * An ordered mempool index, split into shards by a hash of the part of the key that
+ * readers look up by, each with its own reader/writer lock. Lookups do not take the
+ * mempool lock, so they neither wait on each other nor on transactions being accepted,
+ * except for a writer updating the same shard.
+ *
+ * Locking:
+ * - writers (insert, erase, clear) must hold CTxMemPool::cs, and take each shard's lock
+ *   exclusively, one shard at a time, after it. CTxMemPool::cs is what serializes writers.
+ * - readers (find, range) need no other lock and take one shard's lock shared. A reader that
+ *   needs results consistent with mapTx or mapNextTx holds CTxMemPool::cs around the read.
+ * - the order is always CTxMemPool::cs, then at most one shard lock. nothing takes
+ *   CTxMemPool::cs, or a second shard lock, while holding a shard lock.
+ */
+template <typename K, typename V, typename Compare, typename ShardOf>
+class CShardedMempoolIndex
+{
+public:
+    static const size_t SHARD_COUNT = 16;
+
+    // a transaction's entries are added and removed together, one shard at a time, so a reader
+    // sees all or none of them for any one lookup key
+    void insert(const std::vector<std::pair<K, V>> &entries)
+    {
+        for (size_t i = 0; i < SHARD_COUNT; i++)
+        {
+            boost::unique_lock<boost::shared_mutex> lock(shards[i].cs, boost::defer_lock);
+            for (const std::pair<K, V> &entry : entries)
+            {
+                if (ShardOf()(entry.first) % SHARD_COUNT == i)
+                {
+                    if (!lock.owns_lock())
+                        lock.lock();
+                    shards[i].entries.insert(entry);
+                }
+            }
+        }
+    }
+
+    void erase(const std::vector<K> &keys)
+    {
+        for (size_t i = 0; i < SHARD_COUNT; i++)
+        {
+            boost::unique_lock<boost::shared_mutex> lock(shards[i].cs, boost::defer_lock);
+            for (const K &key : keys)
+            {
+                if (ShardOf()(key) % SHARD_COUNT == i)
+                {
+                    if (!lock.owns_lock())
+                        lock.lock();
+                    shards[i].entries.erase(key);
+                }
+            }
+        }
+    }
+
+    bool find(const K &key, V &value) const
+    {
+        const Shard &shard = GetShard(key);
+        boost::shared_lock<boost::shared_mutex> lock(shard.cs);
+        typename std::map<K, V, Compare>::const_iterator it = shard.entries.find(key);
+        if (it == shard.entries.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    // appends entries from the first key not less than start for as long as inRange holds,
+    // all of which must map to the same shard as start
+    template <typename InRange>
+    void range(const K &start, InRange inRange, std::vector<std::pair<K, V>> &results) const
+    {
+        const Shard &shard = GetShard(start);
+        boost::shared_lock<boost::shared_mutex> lock(shard.cs);
+        for (typename std::map<K, V, Compare>::const_iterator it = shard.entries.lower_bound(start);
+             it != shard.entries.end() && inRange(it->first);
+             it++)
+        {
+            results.push_back(*it);
+        }
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < SHARD_COUNT; i++)
+        {
+            boost::unique_lock<boost::shared_mutex> lock(shards[i].cs);
+            shards[i].entries.clear();
+        }
+    }
+
+private:
+    struct Shard
+    {
+        mutable boost::shared_mutex cs;     // taken after CTxMemPool::cs, never together with another shard's
+        std::map<K, V, Compare> entries;
+    };
+    Shard shards[SHARD_COUNT];
+
+    Shard &GetShard(const K &key) { return shards[ShardOf()(key) % SHARD_COUNT]; }
+    const Shard &GetShard(const K &key) const { return shards[ShardOf()(key) % SHARD_COUNT]; }
+};
+
+// all entries of one address share a shard, so a range scan by address stays in one
+struct CMempoolAddressDeltaKeyShard
+{
+    size_t operator()(const CMempoolAddressDeltaKey &key) const { return ReadLE32(key.addressBytes.begin()); }
+};
+
+struct CSpentIndexKeyShard
+{
+    size_t operator()(const CSpentIndexKey &key) const { return ReadLE32(key.txid.begin()) ^ key.outputIndex; }
+};
+
 /**
  * Information about a mempool transaction.
  */
@@ -193,7 +367,8 @@ private:
     std::map<uint256, const CTransaction*> mapSaplingNullifiers;
 
     std::map<uint256, std::pair<double, CAmount> > mapDeltas;
-    std::map<uint256, CReserveTransactionDescriptor> mapReserveTransactions;    // all reserve transactions in the mempool go here
+
+    uint64_t nEvictedTx = 0;   //!< transactions removed by TrimToSize since startup
 
     void checkNullifiers(ShieldedType type) const;
 
@@ -207,17 +382,48 @@ public:
             boost::multi_index::ordered_non_unique<
                 boost::multi_index::identity<CTxMemPoolEntry>,
                 CompareTxMemPoolEntryByFee
+            >,
+            // sorted by modified fee rate, which includes reserve fees, used for eviction
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::identity<CTxMemPoolEntry>,
+                CompareTxMemPoolEntryByScore
             >
         >
     > indexed_transaction_set;
 
+    // guards everything in the pool. mapAddress and mapSpent can also be read under only their shard
+    // locks, which are always taken after this one
     mutable CCriticalSection cs;
     indexed_transaction_set mapTx;
 
+    typedef indexed_transaction_set::iterator txiter;
+    struct CompareIteratorByHash {
+        bool operator()(const txiter &a, const txiter &b) const {
+            return a->GetTx().GetHash() < b->GetTx().GetHash();
+        }
+    };
+    typedef std::set<txiter, CompareIteratorByHash> setEntries;
+
 private:
-    std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> mapAddress;
+    // in-mempool parents and children of each entry, which the package statistics are derived from
+    struct TxLinks {
+        setEntries parents;
+        setEntries children;
+    };
+    typedef std::map<txiter, TxLinks, CompareIteratorByHash> txlinksMap;
+    txlinksMap mapLinks;
+
+    void UpdateLink(txiter parent, txiter child, bool add);
+    void UpdateForAdd(txiter it);
+    void UpdateForRemove(txiter it);
+    void UpdateModifiedFee(txiter it, CAmount newFeeDelta);
+    void RecalculatePackageState(txiter it);
+
+    // written under cs and then each shard's lock, read under only a shard's lock, see CShardedMempoolIndex
+    CShardedMempoolIndex<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare, CMempoolAddressDeltaKeyShard> mapAddress;
+    CShardedMempoolIndex<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare, CSpentIndexKeyShard> mapSpent;
+    // keys added for each transaction, only used by writers, under the mempool lock
     std::map<uint256, std::vector<CMempoolAddressDeltaKey> > mapAddressInserted;
-    std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare> mapSpent;
     std::map<uint256, std::vector<CSpentIndexKey>> mapSpentInserted;
 
 public:
@@ -255,6 +461,24 @@ public:
     void removeForBlock(const std::vector<CTransaction>& vtx, unsigned int nBlockHeight,
                         std::list<CTransaction>& conflicts, bool fCurrentEstimate = true);
     void removeWithoutBranchId(uint32_t nMemPoolBranchId);
+    /**
+     * Remove transactions with the lowest modified fee rate, along with any transactions that spend
+     * them, until the dynamic memory usage is at most sizelimit. If pvNoSpendsRemaining is given, the
+     * txids of confirmed transactions whose outputs are no longer spent by the pool are added to it.
+     * Returns the number of transactions removed.
+     */
+    size_t TrimToSize(size_t sizelimit, std::vector<uint256>* pvNoSpendsRemaining = NULL);
+    /** Collect all in-mempool ancestors or descendants of an entry, not including the entry itself */
+    void CalculateAncestors(txiter it, setEntries &setAncestors) const;
+    void CalculateDescendants(txiter it, setEntries &setDescendants) const;
+    /** Collect the in-mempool ancestors of a transaction that is not in the mempool yet, and check
+     *  that adding it keeps it and every ancestor within the package count and size limits, so
+     *  updating package state on add and remove stays bounded. Sizes are in bytes. On failure,
+     *  returns false and sets errString. */
+    bool CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntries &setAncestors,
+                                   uint64_t limitAncestorCount, uint64_t limitAncestorSize,
+                                   uint64_t limitDescendantCount, uint64_t limitDescendantSize,
+                                   std::string &errString) const;
     void clear();
     void queryHashes(std::vector<uint256>& vtxid);
     void pruneSpent(const uint256& hash, CCoins &coins);
@@ -270,6 +494,8 @@ public:
     void PrioritiseTransaction(const uint256 &hash, const std::string strHash, double dPriorityDelta, const CAmount& nFeeDelta);
     bool PrioritiseReserveTransaction(const CReserveTransactionDescriptor &txDesc);
     bool IsKnownReserveTransaction(const uint256 &hash, CReserveTransactionDescriptor &txDesc);  // know to be reserve transaction, get descriptor, update mempool
+    // descriptor cached on the mempool entry, only if it was computed for the same height on top of the same block
+    bool GetReserveDescriptor(const uint256 &hash, CReserveTransactionDescriptor &txDesc, int32_t nHeight, const uint256 &hashPrevBlock);
     void ApplyDeltas(const uint256 hash, double &dPriorityDelta, CAmount &nFeeDelta);
     void ClearPrioritisation(const uint256 hash);
     bool CompareDepthAndScore(const uint256& hasha, const uint256& hashb);
@@ -291,6 +517,12 @@ public:
         return totalTxSize;
     }
 
+    uint64_t GetEvictedCount()
+    {
+        LOCK(cs);
+        return nEvictedTx;
+    }
+
     std::shared_ptr<const CTransaction> get(const uint256& hash) const;
     TxMempoolInfo info(const uint256& hash) const;
 
@@ -0,0 +1,69 @@
+// Copyright (c) 2021 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_UTXOSTATSINDEX_H
+#define BITCOIN_UTXOSTATSINDEX_H
+
+#include "amount.h"
+#include "crypto/muhash.h"
+#include "primitives/transaction.h"
+#include "serialize.h"
+#include "streams.h"
+#include "version.h"
+
+// statistics of the unspent transparent output set as of a block, keyed by block hash. each block's entry is
+// its parent's with the outputs the block creates added and the outputs it spends removed, so the statistics
+// at any height of the active chain are a single point lookup rather than a scan of the coins database
+struct CUTXOStatsIndexValue {
+    uint64_t nTransactionOutputs;   // number of unspent outputs
+    CAmount nTotalAmount;           // sum of their values
+    uint64_t nBogoSize;             // approximate serialized size, counting a fixed overhead and the script of each output
+    MuHash3072 muhash;              // rolling hash of the set of outpoints and their outputs, independent of order
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nTransactionOutputs);
+        READWRITE(nTotalAmount);
+        READWRITE(nBogoSize);
+        READWRITE(muhash);
+    }
+
+    CUTXOStatsIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        nTransactionOutputs = 0;
+        nTotalAmount = 0;
+        nBogoSize = 0;
+        muhash = MuHash3072();
+    }
+
+    static uint64_t GetBogoSize(const CTxOut &out) {
+        // outpoint, height and coinbase flag, value and script length, as in Bitcoin
+        return 32 + 4 + 4 + 8 + 2 + out.scriptPubKey.size();
+    }
+
+    void AddOutput(const COutPoint &outpoint, const CTxOut &out) {
+        CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+        ss << outpoint << out;
+        muhash.Insert((const unsigned char *)&ss[0], ss.size());
+        nTransactionOutputs++;
+        nTotalAmount += out.nValue;
+        nBogoSize += GetBogoSize(out);
+    }
+
+    void RemoveOutput(const COutPoint &outpoint, const CTxOut &out) {
+        CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+        ss << outpoint << out;
+        muhash.Remove((const unsigned char *)&ss[0], ss.size());
+        nTransactionOutputs--;
+        nTotalAmount -= out.nValue;
+        nBogoSize -= GetBogoSize(out);
+    }
+};
+
+#endif // BITCOIN_UTXOSTATSINDEX_H
@@ -1443,6 +1443,126 @@ TEST(WalletTests, CachedWitnessesCleanIndex) {
     }
 }
 
+TEST(WalletTests, CachedWitnessesSpentNoteRetired) {
+    TestWallet wallet;
+    SproutMerkleTree sproutTree;
+    SaplingMerkleTree saplingTree;
+
+    auto sk = libzcash::SproutSpendingKey::random();
+    wallet.AddSproutSpendingKey(sk);
+
+    // One block to receive the note, one to spend it, then enough blocks to
+    // bury the spend past the witness cache
+    size_t numBlocks = WITNESS_CACHE_SIZE + 5;
+    std::vector<CBlock> blocks(numBlocks);
+    std::vector<CBlockIndex> indices(numBlocks);
+    std::vector<SproutMerkleTree> sproutTrees(numBlocks);
+    std::vector<SaplingMerkleTree> saplingTrees(numBlocks);
+
+    auto wtx = GetValidSproutReceive(sk, 50, true, 4);
+    auto note = GetSproutNote(sk, wtx, 0, 1);
+    auto nullifier = note.nullifier(sk);
+
+    mapSproutNoteData_t noteData;
+    JSOutPoint spentNote {wtx.GetHash(), 0, 1};
+    SproutNoteData nd {sk.address(), nullifier};
+    noteData[spentNote] = nd;
+    wtx.SetSproutNoteData(noteData);
+    wallet.AddToWallet(wtx, true, NULL);
+
+    sproutTrees[0] = sproutTree;
+    saplingTrees[0] = saplingTree;
+    blocks[0].vtx.push_back(wtx);
+    indices[0].SetHeight(1);
+    wallet.IncrementNoteWitnesses(&indices[0], &blocks[0], sproutTree, saplingTree);
+
+    // Fake-mine the spend in the next block
+    auto wtx2 = GetValidSproutSpend(sk, note, 5);
+    sproutTrees[1] = sproutTree;
+    saplingTrees[1] = saplingTree;
+    blocks[1].vtx.push_back(wtx2);
+    blocks[1].hashMerkleRoot = blocks[1].BuildMerkleTree();
+    auto blockHash = blocks[1].GetHash();
+    CBlockIndex spendIndex {blocks[1]};
+    spendIndex.SetHeight(2);
+    mapBlockIndex.insert(std::make_pair(blockHash, &spendIndex));
+    chainActive.SetTip(&spendIndex);
+    EXPECT_TRUE(chainActive.Contains(&spendIndex));
+
+    wtx2.SetMerkleBranch(blocks[1]);
+    wallet.AddToWallet(wtx2, true, NULL);
+    EXPECT_TRUE(wallet.IsSproutSpent(nullifier));
+    wallet.IncrementNoteWitnesses(&spendIndex, &blocks[1], sproutTree, saplingTree);
+
+    std::vector<JSOutPoint> sproutNotes;
+    std::vector<SaplingOutPoint> saplingNotes;
+    std::vector<boost::optional<SproutWitness>> sproutWitnesses;
+    std::vector<boost::optional<SaplingWitness>> saplingWitnesses;
+    std::vector<JSOutPoint> spentNotes {spentNote};
+    std::vector<SaplingOutPoint> noSaplingNotes;
+
+    for (size_t i = 2; i < numBlocks; i++) {
+        sproutTrees[i] = sproutTree;
+        saplingTrees[i] = saplingTree;
+        indices[i].SetHeight(i + 1);
+        auto outpts = CreateValidBlock(wallet, sk, indices[i], blocks[i], sproutTree, saplingTree);
+        sproutNotes.push_back(outpts.first);
+        saplingNotes.push_back(outpts.second);
+
+        // Unspent notes keep a witness to the current tree
+        auto anchors = GetWitnessesAndAnchors(wallet, sproutNotes, saplingNotes, sproutWitnesses, saplingWitnesses);
+        for (size_t j = 0; j < sproutNotes.size(); j++) {
+            EXPECT_TRUE((bool) sproutWitnesses[j]);
+            EXPECT_TRUE((bool) saplingWitnesses[j]);
+        }
+        EXPECT_EQ(sproutTree.root(), anchors.first);
+        EXPECT_EQ(saplingTree.root(), anchors.second);
+
+        // The spent note is witnessed until its spend is buried past the cache
+        auto spentAnchors = GetWitnessesAndAnchors(wallet, spentNotes, noSaplingNotes, sproutWitnesses, saplingWitnesses);
+        if (indices[i].GetHeight() - spendIndex.GetHeight() < (int)WITNESS_CACHE_SIZE) {
+            EXPECT_TRUE((bool) sproutWitnesses[0]);
+            EXPECT_EQ(sproutTree.root(), spentAnchors.first);
+        } else {
+            EXPECT_FALSE((bool) sproutWitnesses[0]);
+        }
+    }
+
+    // Disconnecting and reconnecting the tip still restores the witnesses of
+    // the unspent notes, and leaves the spent note retired
+    size_t tip = numBlocks - 1;
+    wallet.DecrementNoteWitnesses(&indices[tip]);
+    {
+        std::vector<JSOutPoint> prevSproutNotes(sproutNotes.begin(), sproutNotes.end() - 1);
+        std::vector<SaplingOutPoint> prevSaplingNotes(saplingNotes.begin(), saplingNotes.end() - 1);
+        auto anchors = GetWitnessesAndAnchors(wallet, prevSproutNotes, prevSaplingNotes, sproutWitnesses, saplingWitnesses);
+        for (size_t j = 0; j < prevSproutNotes.size(); j++) {
+            EXPECT_TRUE((bool) sproutWitnesses[j]);
+            EXPECT_TRUE((bool) saplingWitnesses[j]);
+        }
+        EXPECT_EQ(sproutTrees[tip].root(), anchors.first);
+        EXPECT_EQ(saplingTrees[tip].root(), anchors.second);
+    }
+
+    wallet.IncrementNoteWitnesses(&indices[tip], &blocks[tip], sproutTrees[tip], saplingTrees[tip]);
+    {
+        auto anchors = GetWitnessesAndAnchors(wallet, sproutNotes, saplingNotes, sproutWitnesses, saplingWitnesses);
+        for (size_t j = 0; j < sproutNotes.size(); j++) {
+            EXPECT_TRUE((bool) sproutWitnesses[j]);
+            EXPECT_TRUE((bool) saplingWitnesses[j]);
+        }
+        EXPECT_EQ(sproutTree.root(), anchors.first);
+        EXPECT_EQ(saplingTree.root(), anchors.second);
+
+        GetWitnessesAndAnchors(wallet, spentNotes, noSaplingNotes, sproutWitnesses, saplingWitnesses);
+        EXPECT_FALSE((bool) sproutWitnesses[0]);
+    }
+
+    // Tear down
+    chainActive.SetTip(NULL);
+    mapBlockIndex.erase(blockHash);
+}
+
 TEST(WalletTests, ClearNoteWitnessCache) {
     TestWallet wallet;
 
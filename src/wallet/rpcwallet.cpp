@@ -4324,6 +4324,17 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
             "Runs a benchmark of the selected type samplecount times,\n"
             "returning the running times of each sample.\n"
             "\n"
+            "The VerusHash benchmarks (verushash, verushashv2, verushashv2b, verusclhash, haraka512\n"
+            "and haraka256) time " + std::to_string(VERUSHASH_BENCHMARK_ITERATIONS) + " hashes per sample, taking an optional\n"
+            "variant (verusclhash, e.g. \"verusclhash_sv2_2_port\") or portable flag (haraka) followed\n"
+            "by an optional thread count, which returns one sample per thread.\n"
+            "\n"
+            "trydecryptsaplingnotes takes a number of keys and an optional number of threads to\n"
+            "trial decrypt with (default: the number of cores).\n"
+            "\n"
+            "currencyvaluemap times " + std::to_string(CURRENCY_VALUE_MAP_BENCHMARK_ITERATIONS) + " rounds of currency value map additions,\n"
+            "subtractions and comparisons per sample, taking an optional number of currencies per map (default: 4).\n"
+            "\n"
             "Output: [\n"
             "  {\n"
             "    \"runningtime\": runningtime\n"
@@ -4383,6 +4394,41 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
 #endif
         } else if (benchmarktype == "verifyequihash") {
             sample_times.push_back(benchmark_verify_equihash());
+        } else if (benchmarktype == "verushash" || benchmarktype == "verushashv2" || benchmarktype == "verushashv2b") {
+            bool v2b = benchmarktype == "verushashv2b";
+            bool v2 = benchmarktype == "verushashv2";
+            if (params.size() < 3) {
+                sample_times.push_back(v2b ? benchmark_verus_hash_v2b() : v2 ? benchmark_verus_hash_v2() : benchmark_verus_hash());
+            } else {
+                int nThreads = params[2].get_int();
+                std::vector<double> vals = v2b ? benchmark_verus_hash_v2b_threaded(nThreads) :
+                                           v2 ? benchmark_verus_hash_v2_threaded(nThreads) :
+                                                benchmark_verus_hash_threaded(nThreads);
+                sample_times.insert(sample_times.end(), vals.begin(), vals.end());
+            }
+        } else if (benchmarktype == "verusclhash") {
+            std::string variant = params.size() < 3 ? "verusclhash_sv2_2" : params[2].get_str();
+            if (!benchmark_verusclhash_supported(variant)) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown verusclhash variant or not supported on this CPU: " + variant);
+            }
+            if (params.size() < 4) {
+                sample_times.push_back(benchmark_verusclhash(variant));
+            } else {
+                int nThreads = params[3].get_int();
+                std::vector<double> vals = benchmark_verusclhash_threaded(variant, nThreads);
+                sample_times.insert(sample_times.end(), vals.begin(), vals.end());
+            }
+        } else if (benchmarktype == "haraka512" || benchmarktype == "haraka256") {
+            bool portable = (params.size() >= 3 && params[2].get_bool()) || !IsCPUVerusOptimized();
+            bool h512 = benchmarktype == "haraka512";
+            if (params.size() < 4) {
+                sample_times.push_back(h512 ? benchmark_haraka512(portable) : benchmark_haraka256(portable));
+            } else {
+                int nThreads = params[3].get_int();
+                std::vector<double> vals = h512 ? benchmark_haraka512_threaded(portable, nThreads) :
+                                                  benchmark_haraka256_threaded(portable, nThreads);
+                sample_times.insert(sample_times.end(), vals.begin(), vals.end());
+            }
         } else if (benchmarktype == "validatelargetx") {
             // Number of inputs in the spending transaction that we will simulate
             int nInputs = 11130;
@@ -4395,7 +4441,17 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
             sample_times.push_back(benchmark_try_decrypt_sprout_notes(nKeys));
         } else if (benchmarktype == "trydecryptsaplingnotes") {
             int nKeys = params[2].get_int();
-            sample_times.push_back(benchmark_try_decrypt_sapling_notes(nKeys));
+            int nThreads = params.size() > 3 ? params[3].get_int() : GetNumCores();
+            if (nThreads < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid thread count");
+            }
+            sample_times.push_back(benchmark_try_decrypt_sapling_notes(nKeys, nThreads));
+        } else if (benchmarktype == "currencyvaluemap") {
+            int nCurrencies = params.size() > 2 ? params[2].get_int() : 4;
+            if (nCurrencies < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid number of currencies");
+            }
+            sample_times.push_back(benchmark_currency_value_map(nCurrencies));
         } else if (benchmarktype == "incnotewitnesses") {
             int nTxs = params[2].get_int();
             sample_times.push_back(benchmark_increment_sprout_note_witnesses(nTxs));
@@ -1321,11 +1321,17 @@ void CWallet::ClearNoteWitnessCache()
     //fprintf(stderr,"Clear witness cache\n");
 }
 
-template<typename NoteDataMap>
-void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize)
+template<typename NoteDataMap, typename IsSpendFinal, typename NoteData>
+void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, IsSpendFinal isSpendFinal, std::vector<NoteData*>& witnessed)
 {
     for (auto& item : noteDataMap) {
         auto* nd = &(item.second);
+        // A note whose spend is buried deeper than the witness cache can't become
+        // spendable again without a reorg that would invalidate the cache anyway,
+        // so its witnesses are dropped rather than updated on every block.
+        if (nd->witnesses.size() > 0 && nd->nullifier && isSpendFinal(nd->nullifier.get())) {
+            nd->witnesses.clear();
+        }
         // Only increment witnesses that are behind the current height
         if (nd->witnessHeight < indexHeight) {
             // Check the validity of the cache
@@ -1344,30 +1350,34 @@ void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nW
             if (nd->witnesses.size() > WITNESS_CACHE_SIZE) {
                 nd->witnesses.pop_back();
             }
+            // These are the witnesses that get this block's commitments
+            if (nd->witnesses.size() > 0) {
+                witnessed.push_back(nd);
+            }
         }
     }
 }
 
-template<typename NoteDataMap>
-void AppendNoteCommitment(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const uint256& note_commitment)
+template<typename NoteData>
+void AppendNoteCommitment(std::vector<NoteData*>& witnessed, int64_t nWitnessCacheSize, const uint256& note_commitment)
 {
-    for (auto& item : noteDataMap) {
-        auto* nd = &(item.second);
-        if (nd->witnessHeight < indexHeight && nd->witnesses.size() > 0) {
-            // Check the validity of the cache
-            // See comment in CopyPreviousWitnesses about validity.
-            assert(nWitnessCacheSize >= nd->witnesses.size());
-            nd->witnesses.front().append(note_commitment);
-        }
+    for (NoteData* nd : witnessed) {
+        // Check the validity of the cache
+        // See comment in CopyPreviousWitnesses about validity.
+        assert(nWitnessCacheSize >= nd->witnesses.size());
+        nd->witnesses.front().append(note_commitment);
     }
 }
 
 template<typename OutPoint, typename NoteData, typename Witness>
-void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const OutPoint& key, const Witness& witness)
+void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const OutPoint& key, const Witness& witness, std::vector<NoteData*>& witnessed)
 {
     if (noteDataMap.count(key) && noteDataMap[key].witnessHeight < indexHeight) {
         auto* nd = &(noteDataMap[key]);
-        if (nd->witnesses.size() > 0) {
+        if (nd->witnesses.size() == 0) {
+            // Later commitments in this block extend the new witness
+            witnessed.push_back(nd);
+        } else {
             // We think this can happen because we write out the
             // witness cache state after every block increment or
             // decrement, but the block index itself is written in
@@ -1413,9 +1423,35 @@ void CWallet::IncrementNoteWitnesses(const CBlockIndex* pindex,
                                      SaplingMerkleTree& saplingTree)
 {
     LOCK(cs_wallet);
+    int nHeight = pindex->GetHeight();
+    auto isSpendFinal = [this, nHeight](const TxNullifiers& nullifiers, const uint256& nullifier) {
+        auto range = nullifiers.equal_range(nullifier);
+        for (TxNullifiers::const_iterator it = range.first; it != range.second; ++it) {
+            std::map<uint256, CWalletTx>::const_iterator mit = mapWallet.find(it->second);
+            if (mit == mapWallet.end() || mit->second.hashBlock.IsNull()) {
+                continue;
+            }
+            BlockMap::const_iterator bit = mapBlockIndex.find(mit->second.hashBlock);
+            if (bit != mapBlockIndex.end() &&
+                chainActive.Contains(bit->second) &&
+                nHeight - bit->second->GetHeight() >= (int)WITNESS_CACHE_SIZE) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Collect the notes that have witnesses to advance once, so each commitment only
+    // touches those, rather than every note of every wallet transaction
+    std::vector<SproutNoteData*> sproutWitnessed;
+    std::vector<SaplingNoteData*> saplingWitnessed;
     for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-       ::CopyPreviousWitnesses(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize);
-       ::CopyPreviousWitnesses(wtxItem.second.mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize);
+        ::CopyPreviousWitnesses(wtxItem.second.mapSproutNoteData, nHeight, nWitnessCacheSize,
+                                [&](const uint256& nf) { return isSpendFinal(mapTxSproutNullifiers, nf); },
+                                sproutWitnessed);
+        ::CopyPreviousWitnesses(wtxItem.second.mapSaplingNoteData, nHeight, nWitnessCacheSize,
+                                [&](const uint256& nf) { return isSpendFinal(mapTxSaplingNullifiers, nf); },
+                                saplingWitnessed);
     }
 
     if (nWitnessCacheSize < WITNESS_CACHE_SIZE) {
@@ -1440,14 +1476,12 @@ void CWallet::IncrementNoteWitnesses(const CBlockIndex* pindex,
                 sproutTree.append(note_commitment);
 
                 // Increment existing witnesses
-                for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-                    ::AppendNoteCommitment(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, note_commitment);
-                }
+                ::AppendNoteCommitment(sproutWitnessed, nWitnessCacheSize, note_commitment);
 
                 // If this is our note, witness it
                 if (txIsOurs) {
                     JSOutPoint jsoutpt {hash, i, j};
-                    ::WitnessNoteIfMine(mapWallet[hash].mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, jsoutpt, sproutTree.witness());
+                    ::WitnessNoteIfMine(mapWallet[hash].mapSproutNoteData, nHeight, nWitnessCacheSize, jsoutpt, sproutTree.witness(), sproutWitnessed);
                 }
             }
         }
@@ -1457,14 +1491,12 @@ void CWallet::IncrementNoteWitnesses(const CBlockIndex* pindex,
             saplingTree.append(note_commitment);
 
             // Increment existing witnesses
-            for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-                ::AppendNoteCommitment(wtxItem.second.mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, note_commitment);
-            }
+            ::AppendNoteCommitment(saplingWitnessed, nWitnessCacheSize, note_commitment);
 
             // If this is our note, witness it
             if (txIsOurs) {
                 SaplingOutPoint outPoint {hash, i};
-                ::WitnessNoteIfMine(mapWallet[hash].mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, outPoint, saplingTree.witness());
+                ::WitnessNoteIfMine(mapWallet[hash].mapSaplingNoteData, nHeight, nWitnessCacheSize, outPoint, saplingTree.witness(), saplingWitnessed);
             }
         }
     }
@@ -2582,7 +2614,8 @@ bool CWallet::MarkIdentityDirty(const CIdentityID &idID)
  * updated; instead, the transaction being in the mempool or conflicted is determined on
  * the fly in CMerkleTx::GetDepthInMainChain().
  */
-bool CWallet::AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate, bool isRescan)
+bool CWallet::AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate, bool isRescan,
+                                       const std::vector<SaplingTrialDecryption> *pSaplingDecrypted)
 {
     {
         AssertLockHeld(cs_wallet);
@@ -2593,7 +2626,7 @@ bool CWallet::AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pbl
         bool isNewID = false;
         if (fExisted && !fUpdate) return false;
         auto sproutNoteData = FindMySproutNotes(tx);
-        auto saplingNoteDataAndAddressesToAdd = FindMySaplingNotes(tx);
+        auto saplingNoteDataAndAddressesToAdd = pSaplingDecrypted ? FindMySaplingNotes(tx, *pSaplingDecrypted) : FindMySaplingNotes(tx);
         auto saplingNoteData = saplingNoteDataAndAddressesToAdd.first;
         auto addressesToAdd = saplingNoteDataAndAddressesToAdd.second;
         for (const auto &addressToAdd : addressesToAdd) {
@@ -3494,6 +3527,13 @@ mapSproutNoteData_t CWallet::FindMySproutNotes(const CTransaction &tx) const
  * already have been cached in CWalletTx.mapSaplingNoteData.
  */
 std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> CWallet::FindMySaplingNotes(const CTransaction &tx) const
+{
+    LOCK(cs_SpendingKeyStore);
+    return FindMySaplingNotes(tx, TrialDecryptSaplingOutputs(tx, GetSaplingIncomingViewingKeys(), GetNumCores()));
+}
+
+std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> CWallet::FindMySaplingNotes(const CTransaction &tx,
+                                                                                          const std::vector<SaplingTrialDecryption> &decrypted) const
 {
     LOCK(cs_SpendingKeyStore);
     uint256 hash = tx.GetHash();
@@ -3501,30 +3541,132 @@ std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> CWallet::FindMySap
     mapSaplingNoteData_t noteData;
     SaplingIncomingViewingKeyMap viewingKeysToAdd;
 
-    // Protocol Spec: 4.19 Block Chain Scanning (Sapling)
-    for (uint32_t i = 0; i < tx.vShieldedOutput.size(); ++i) {
-        const OutputDescription output = tx.vShieldedOutput[i];
-        for (auto it = mapSaplingFullViewingKeys.begin(); it != mapSaplingFullViewingKeys.end(); ++it) {
-            SaplingIncomingViewingKey ivk = it->first;
-            auto result = SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cm);
-            if (!result) {
-                continue;
+    for (const SaplingTrialDecryption &one : decrypted) {
+        if (one.address && mapSaplingIncomingViewingKeys.count(one.address.get()) == 0) {
+            viewingKeysToAdd[one.address.get()] = one.ivk;
+        }
+        // We don't cache the nullifier here as computing it requires knowledge of the note position
+        // in the commitment tree, which can only be determined when the transaction has been mined.
+        SaplingOutPoint op {hash, one.outputIndex};
+        SaplingNoteData nd;
+        nd.ivk = one.ivk;
+        noteData.insert(std::make_pair(op, nd));
+    }
+
+    return std::make_pair(noteData, viewingKeysToAdd);
+}
+
+std::vector<SaplingTrialDecryption> CWallet::TrialDecryptSaplingOutputs(const CTransaction &tx,
+                                                                        const std::vector<libzcash::SaplingIncomingViewingKey> &ivks,
+                                                                        int nThreads)
+{
+    return TrialDecryptSaplingOutputs(std::vector<const CTransaction *>({&tx}), ivks, nThreads)[0];
+}
+
+// fewest (output, key) attempts worth starting any threads for. this is called for every transaction
+// synced to the wallet or arriving in the mempool, most of which have one or two outputs, so below this
+// starting threads costs more than it saves and the attempts run on the calling thread
+static const size_t MIN_SAPLING_TRIAL_DECRYPTIONS_PARALLEL = 1024;
+// fewest (output, key) attempts worth starting another thread for
+static const size_t MIN_SAPLING_TRIAL_DECRYPTIONS_PER_THREAD = 256;
+// keys tried in one unit of work, so outputs with many keys spread across threads
+static const size_t SAPLING_TRIAL_DECRYPTION_KEY_CHUNK = 64;
+
+std::vector<std::vector<SaplingTrialDecryption>> CWallet::TrialDecryptSaplingOutputs(const std::vector<const CTransaction *> &txes,
+                                                                                     const std::vector<libzcash::SaplingIncomingViewingKey> &ivks,
+                                                                                     int nThreads)
+{
+    std::vector<std::vector<SaplingTrialDecryption>> results(txes.size());
+
+    std::vector<std::pair<size_t, uint32_t>> outputs;     // transaction and output index
+    for (size_t i = 0; i < txes.size(); i++) {
+        for (uint32_t j = 0; j < txes[i]->vShieldedOutput.size(); j++) {
+            outputs.push_back(std::make_pair(i, j));
+        }
+    }
+    if (outputs.empty() || ivks.empty()) {
+        return results;
+    }
+
+    // each unit of work is one output against a consecutive chunk of keys
+    size_t nKeyChunks = (ivks.size() + SAPLING_TRIAL_DECRYPTION_KEY_CHUNK - 1) / SAPLING_TRIAL_DECRYPTION_KEY_CHUNK;
+    size_t nUnits = outputs.size() * nKeyChunks;
+    size_t nAttempts = outputs.size() * ivks.size();
+    if (nAttempts < MIN_SAPLING_TRIAL_DECRYPTIONS_PARALLEL) {
+        nThreads = 1;
+    } else {
+        nThreads = std::max(1, (int)std::min(std::min((size_t)nThreads, nUnits), nAttempts / MIN_SAPLING_TRIAL_DECRYPTIONS_PER_THREAD));
+    }
+
+    // lowest index of a key found to decrypt each output. as in an ordered scan of the keys, that is
+    // the one used, and any thread can skip the keys after it
+    std::unique_ptr<std::atomic<size_t>[]> firstKey(new std::atomic<size_t>[outputs.size()]);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        firstKey[i] = ivks.size();
+    }
+    std::vector<std::vector<SaplingTrialDecryption>> found(nThreads);
+    std::atomic<size_t> nNextUnit(0);
+
+    auto work = [&](int nThread) {
+        size_t nUnit;
+        while ((nUnit = nNextUnit++) < nUnits) {
+            size_t nOutput = nUnit / nKeyChunks;
+            size_t nKey = (nUnit % nKeyChunks) * SAPLING_TRIAL_DECRYPTION_KEY_CHUNK;
+            size_t nKeyEnd = std::min(nKey + SAPLING_TRIAL_DECRYPTION_KEY_CHUNK, ivks.size());
+            const OutputDescription &output = txes[outputs[nOutput].first]->vShieldedOutput[outputs[nOutput].second];
+
+            for (; nKey < nKeyEnd && nKey < firstKey[nOutput]; nKey++) {
+                const SaplingIncomingViewingKey &ivk = ivks[nKey];
+                auto result = SaplingNotePlaintext::decrypt(output.encCiphertext, ivk, output.ephemeralKey, output.cm);
+                if (!result) {
+                    continue;
+                }
+                found[nThread].push_back(SaplingTrialDecryption{(uint32_t)nOutput, ivk, ivk.address(result.get().d)});
+                size_t nFirst = firstKey[nOutput];
+                while (nKey < nFirst && !firstKey[nOutput].compare_exchange_weak(nFirst, nKey));
+                break;
             }
-            auto address = ivk.address(result.get().d);
-            if (address && mapSaplingIncomingViewingKeys.count(address.get()) == 0) {
-                viewingKeysToAdd[address.get()] = ivk;
+        }
+    };
+
+    if (nThreads == 1) {
+        work(0);
+    } else {
+        boost::thread_group threads;
+        for (int i = 0; i < nThreads; i++) {
+            threads.create_thread(boost::bind<void>(work, i));
+        }
+        threads.join_all();
+    }
+
+    // keep only the decryption with the first key for each output, in output order
+    std::vector<const SaplingTrialDecryption *> byOutput(outputs.size(), nullptr);
+    for (const std::vector<SaplingTrialDecryption> &oneThread : found) {
+        for (const SaplingTrialDecryption &one : oneThread) {
+            if (ivks[firstKey[one.outputIndex]] == one.ivk) {
+                byOutput[one.outputIndex] = &one;
             }
-            // We don't cache the nullifier here as computing it requires knowledge of the note position
-            // in the commitment tree, which can only be determined when the transaction has been mined.
-            SaplingOutPoint op {hash, i};
-            SaplingNoteData nd;
-            nd.ivk = ivk;
-            noteData.insert(std::make_pair(op, nd));
-            break;
         }
     }
+    for (size_t i = 0; i < outputs.size(); i++) {
+        if (byOutput[i]) {
+            SaplingTrialDecryption one = *byOutput[i];
+            one.outputIndex = outputs[i].second;
+            results[outputs[i].first].push_back(one);
+        }
+    }
+    return results;
+}
 
-    return std::make_pair(noteData, viewingKeysToAdd);
+std::vector<libzcash::SaplingIncomingViewingKey> CWallet::GetSaplingIncomingViewingKeys() const
+{
+    LOCK(cs_SpendingKeyStore);
+    std::vector<SaplingIncomingViewingKey> ivks;
+    ivks.reserve(mapSaplingFullViewingKeys.size());
+    for (auto it = mapSaplingFullViewingKeys.begin(); it != mapSaplingFullViewingKeys.end(); ++it) {
+        ivks.push_back(it->first);
+    }
+    return ivks;
 }
 
 bool CWallet::IsSproutNullifierFromMe(const uint256& nullifier) const
@@ -4305,6 +4447,115 @@ void CWallet::ReorderWalletTransactions(std::map<std::pair<int,int>, CWalletTx*>
     }
 }
 
+/**
+ * Reads the blocks of a rescan ahead of the wallet on worker threads, and trial decrypts
+ * their Sapling outputs there, handing them back in chain order. Only reading and trial
+ * decryption, which don't depend on wallet state, run off the rescanning thread, so the
+ * wallet still sees every block and transaction in order.
+ */
+class CRescanBlockPrefetcher
+{
+public:
+    struct CPrefetchedBlock
+    {
+        bool fRead = false;
+        CBlock block;
+        std::vector<std::vector<SaplingTrialDecryption>> saplingDecrypted;    // per transaction
+    };
+
+    CRescanBlockPrefetcher(const std::vector<CBlockIndex *> &blocks,
+                           const std::vector<libzcash::SaplingIncomingViewingKey> &ivks,
+                           int nThreads) :
+        vBlocks(blocks), vIvks(ivks), nWindow(nThreads * 4), nNextRead(0), nNextUsed(0), fStop(false)
+    {
+        for (int i = 0; i < nThreads; i++)
+        {
+            threads.create_thread(boost::bind(&CRescanBlockPrefetcher::ThreadPrefetch, this));
+        }
+    }
+
+    ~CRescanBlockPrefetcher()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(cs);
+            fStop = true;
+        }
+        cond.notify_all();
+        threads.join_all();
+    }
+
+    // waits for the block at index i of the list, which must be requested in order
+    std::shared_ptr<CPrefetchedBlock> Get(size_t i)
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        std::map<size_t, std::shared_ptr<CPrefetchedBlock>>::iterator it;
+        while ((it = mapReady.find(i)) == mapReady.end())
+        {
+            cond.wait(lock);
+        }
+        std::shared_ptr<CPrefetchedBlock> result = it->second;
+        mapReady.erase(it);
+        nNextUsed = i + 1;
+        cond.notify_all();
+        return result;
+    }
+
+private:
+    const std::vector<CBlockIndex *> &vBlocks;
+    const std::vector<libzcash::SaplingIncomingViewingKey> &vIvks;
+    const size_t nWindow;
+
+    boost::mutex cs;
+    boost::condition_variable cond;
+    size_t nNextRead;
+    size_t nNextUsed;
+    bool fStop;
+    std::map<size_t, std::shared_ptr<CPrefetchedBlock>> mapReady;
+    boost::thread_group threads;
+
+    void ThreadPrefetch()
+    {
+        RenameThread("zcash-rescan");
+        while (true)
+        {
+            size_t i;
+            {
+                boost::unique_lock<boost::mutex> lock(cs);
+                while (!fStop && nNextRead < vBlocks.size() && nNextRead >= nNextUsed + nWindow)
+                {
+                    cond.wait(lock);
+                }
+                if (fStop || nNextRead >= vBlocks.size())
+                {
+                    return;
+                }
+                i = nNextRead++;
+            }
+
+            // reading a block doesn't touch the block index beyond its position, which can't
+            // change while the rescanning thread holds cs_main
+            std::shared_ptr<CPrefetchedBlock> prefetched = std::make_shared<CPrefetchedBlock>();
+            prefetched->fRead = ReadBlockFromDisk(prefetched->block, vBlocks[i], Params().GetConsensus());
+            if (prefetched->fRead && vIvks.size())
+            {
+                // the prefetching threads already run in parallel, so each decrypts its block as one batch
+                std::vector<const CTransaction *> txes;
+                for (const CTransaction &tx : prefetched->block.vtx)
+                {
+                    txes.push_back(&tx);
+                }
+                prefetched->saplingDecrypted = CWallet::TrialDecryptSaplingOutputs(txes, vIvks, 1);
+            }
+
+            {
+                boost::unique_lock<boost::mutex> lock(cs);
+                mapReady[i] = prefetched;
+            }
+            cond.notify_all();
+        }
+    }
+};
+
 /**
  * Scan the block chain (starting in pindexStart) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -4336,8 +4587,21 @@ int CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate)
         ShowProgress(_("Rescanning..."), 0); // show rescan progress in GUI as dialog or on splashscreen, if -rescan on startup
         double dProgressStart = Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), pindex, false);
         double dProgressTip = Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), chainActive.LastTip(), false);
-        while (pindex)
+
+        // cs_main is held for the whole rescan, so the blocks to scan are known up front
+        std::vector<CBlockIndex *> vBlocks;
+        for (CBlockIndex *pnext = pindex; pnext; pnext = chainActive.Next(pnext))
         {
+            vBlocks.push_back(pnext);
+        }
+        std::vector<libzcash::SaplingIncomingViewingKey> vIvks = GetSaplingIncomingViewingKeys();
+        int nThreads = std::max(1, std::min(GetNumCores(), (int)GetArg("-rescanthreads", DEFAULT_RESCAN_THREADS)));
+        CRescanBlockPrefetcher prefetcher(vBlocks, vIvks, nThreads);
+
+        for (size_t nBlock = 0; nBlock < vBlocks.size(); nBlock++)
+        {
+            pindex = vBlocks[nBlock];
+
             //exit loop if trying to shutdown
             if (ShutdownRequested()) {
                 break;
@@ -4346,11 +4610,13 @@ int CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate)
             if (pindex->GetHeight() % 100 == 0 && dProgressTip - dProgressStart > 0.0)
                 ShowProgress(_("Rescanning..."), std::max(1, std::min(99, (int)((Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), pindex, false) - dProgressStart) / (dProgressTip - dProgressStart) * 100))));
 
-            CBlock block;
-            ReadBlockFromDisk(block, pindex, Params().GetConsensus());
-            BOOST_FOREACH(CTransaction& tx, block.vtx)
+            std::shared_ptr<CRescanBlockPrefetcher::CPrefetchedBlock> prefetched = prefetcher.Get(nBlock);
+            const CBlock &block = prefetched->block;
+            for (size_t i = 0; i < block.vtx.size(); i++)
             {
-                if (AddToWalletIfInvolvingMe(tx, &block, fUpdate, true)) {
+                const CTransaction &tx = block.vtx[i];
+                if (AddToWalletIfInvolvingMe(tx, &block, fUpdate, true,
+                                             i < prefetched->saplingDecrypted.size() ? &prefetched->saplingDecrypted[i] : nullptr)) {
                     myTxHashes.push_back(tx.GetHash());
                     ret++;
                 }
@@ -4369,10 +4635,10 @@ int CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate)
             // Increment note witness caches
             ChainTipAdded(pindex, &block, sproutTree, saplingTree);
 
-            pindex = chainActive.Next(pindex);
             if (GetTime() >= nNow + 60) {
                 nNow = GetTime();
-                LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex ? pindex->GetHeight() : -1, Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), pindex));
+                CBlockIndex *pnext = chainActive.Next(pindex);
+                LogPrintf("Still rescanning. At block %d. Progress=%f\n", pnext ? pnext->GetHeight() : -1, Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), pnext));
             }
         }
 
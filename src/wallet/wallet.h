@@ -58,6 +58,8 @@ static const CAmount nHighTransactionFeeWarning = 0.01 * COIN;
 static const CAmount DEFAULT_TRANSACTION_MAXFEE = 0.1 * COIN;
 //! -txconfirmtarget default
 static const unsigned int DEFAULT_TX_CONFIRM_TARGET = 2;
+//! -rescanthreads default, threads reading and trial decrypting blocks ahead of a rescan
+static const int DEFAULT_RESCAN_THREADS = 4;
 //! -maxtxfee will warn if called with a higher fee than this amount (in satoshis)
 static const CAmount nHighTransactionMaxFeeWarning = 100 * nHighTransactionFeeWarning;
 //! Largest (in bytes) free transaction we're willing to create
@@ -319,6 +321,14 @@ public:
 typedef std::map<JSOutPoint, SproutNoteData> mapSproutNoteData_t;
 typedef std::map<SaplingOutPoint, SaplingNoteData> mapSaplingNoteData_t;
 
+/** A Sapling output of a transaction that decrypted under one of the wallet's incoming viewing keys */
+struct SaplingTrialDecryption
+{
+    uint32_t outputIndex;
+    libzcash::SaplingIncomingViewingKey ivk;
+    boost::optional<libzcash::SaplingPaymentAddress> address;
+};
+
 /** Sprout note, its location in a transaction, and number of confirmations. */
 struct SproutNoteEntry
 {
@@ -1254,7 +1264,8 @@ public:
     void RescanWallet();
     std::pair<bool, bool> CheckAuthority(const CIdentity &identity);
     bool MarkIdentityDirty(const CIdentityID &idID);
-    bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate, bool isRescan);
+    bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate, bool isRescan,
+                                  const std::vector<SaplingTrialDecryption> *pSaplingDecrypted=nullptr);
     void WitnessNoteCommitment(
          std::vector<uint256> commitments,
          std::vector<boost::optional<SproutWitness>>& witnesses,
@@ -1319,6 +1330,19 @@ public:
         uint8_t n) const;
     mapSproutNoteData_t FindMySproutNotes(const CTransaction& tx) const;
     std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> FindMySaplingNotes(const CTransaction& tx) const;
+    // same as above, from the result of TrialDecryptSaplingOutputs with the wallet's viewing keys
+    std::pair<mapSaplingNoteData_t, SaplingIncomingViewingKeyMap> FindMySaplingNotes(const CTransaction& tx,
+                                                                                     const std::vector<SaplingTrialDecryption> &decrypted) const;
+    // trial decrypts each Sapling output with the given keys in order, needs no wallet locks
+    static std::vector<SaplingTrialDecryption> TrialDecryptSaplingOutputs(const CTransaction& tx,
+                                                                          const std::vector<libzcash::SaplingIncomingViewingKey> &ivks,
+                                                                          int nThreads=1);
+    // the same for all outputs of a set of transactions, such as a block, as one batch of
+    // (output, key) attempts split across up to nThreads threads, with results per transaction
+    static std::vector<std::vector<SaplingTrialDecryption>> TrialDecryptSaplingOutputs(const std::vector<const CTransaction *> &txes,
+                                                                                       const std::vector<libzcash::SaplingIncomingViewingKey> &ivks,
+                                                                                       int nThreads);
+    std::vector<libzcash::SaplingIncomingViewingKey> GetSaplingIncomingViewingKeys() const;
     bool IsSproutNullifierFromMe(const uint256& nullifier) const;
     bool IsSaplingNullifierFromMe(const uint256& nullifier) const;
 
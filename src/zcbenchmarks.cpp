@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <functional>
 #include <future>
 #include <map>
 #include <thread>
@@ -11,6 +12,7 @@
 #include "primitives/transaction.h"
 #include "base58.h"
 #include "crypto/equihash.h"
+#include "crypto/verus_hash.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "consensus/upgrades.h"
@@ -236,6 +238,188 @@ double benchmark_verify_equihash()
     return timer_stop(tv_start);
 }
 
+// runs a single threaded benchmark on each of nThreads threads at the same time
+static std::vector<double> benchmark_threaded(std::function<double(void)> benchmark, int nThreads)
+{
+    std::vector<double> ret;
+    std::vector<std::future<double>> tasks;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nThreads; i++) {
+        std::packaged_task<double(void)> task(benchmark);
+        tasks.emplace_back(task.get_future());
+        threads.emplace_back(std::move(task));
+    }
+    for (auto it = tasks.begin(); it != tasks.end(); it++) {
+        it->wait();
+        ret.push_back(it->get());
+    }
+    for (auto it = threads.begin(); it != threads.end(); it++) {
+        it->join();
+    }
+    return ret;
+}
+
+// the genesis block header, serialized as it is for hashing, is the input to all of the VerusHash benchmarks
+static std::vector<unsigned char> benchmark_verus_hash_input()
+{
+    CDataStream ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << Params(CBaseChainParams::MAIN).GenesisBlock().GetBlockHeader();
+    return std::vector<unsigned char>(ss.begin(), ss.end());
+}
+
+double benchmark_verus_hash()
+{
+    std::vector<unsigned char> input = benchmark_verus_hash_input();
+    uint256 result;
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        *(int *)&input[0] = i;
+        verus_hash(&result, &input[0], input.size());
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_verus_hash_threaded(int nThreads)
+{
+    return benchmark_threaded(&benchmark_verus_hash, nThreads);
+}
+
+double benchmark_verus_hash_v2()
+{
+    std::vector<unsigned char> input = benchmark_verus_hash_input();
+    uint256 result;
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        *(int *)&input[0] = i;
+        verus_hash_v2(&result, &input[0], input.size());
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_verus_hash_v2_threaded(int nThreads)
+{
+    return benchmark_threaded(&benchmark_verus_hash_v2, nThreads);
+}
+
+// the complete block hash path, serializing the header into the writer and finishing with Finalize2b
+double benchmark_verus_hash_v2b()
+{
+    CBlockHeader header = Params(CBaseChainParams::MAIN).GenesisBlock().GetBlockHeader();
+    CVerusHashV2bWriter hashWriter(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+    uint256 result;
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        header.nNonce = ArithToUint256(arith_uint256(i));
+        hashWriter.Reset();
+        hashWriter << header;
+        result = hashWriter.GetHash();
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_verus_hash_v2b_threaded(int nThreads)
+{
+    return benchmark_threaded(&benchmark_verus_hash_v2b, nThreads);
+}
+
+static const std::map<std::string, std::pair<int, uint64_t (*)(void *, const unsigned char *, uint64_t, __m128i **)>> verusclhashVariants = {
+    {"verusclhash", {SOLUTION_VERUSHHASH_V2, &verusclhash}},
+    {"verusclhash_sv2_1", {SOLUTION_VERUSHHASH_V2_1, &verusclhash_sv2_1}},
+    {"verusclhash_sv2_2", {SOLUTION_VERUSHHASH_V2_2, &verusclhash_sv2_2}},
+    {"verusclhash_port", {SOLUTION_VERUSHHASH_V2, &verusclhash_port}},
+    {"verusclhash_sv2_1_port", {SOLUTION_VERUSHHASH_V2_1, &verusclhash_sv2_1_port}},
+    {"verusclhash_sv2_2_port", {SOLUTION_VERUSHHASH_V2_2, &verusclhash_sv2_2_port}}
+};
+
+bool benchmark_verusclhash_supported(const std::string &variant)
+{
+    return verusclhashVariants.count(variant) &&
+           (IsCPUVerusOptimized() || variant.size() > 5 && variant.substr(variant.size() - 5) == "_port");
+}
+
+// the intermediate CLHash step of VerusHash 2.x alone, including the key refresh after each hash
+double benchmark_verusclhash(const std::string &variant)
+{
+    auto it = verusclhashVariants.find(variant);
+    assert(it != verusclhashVariants.end());
+
+    verusclhasher vclh(VERUSKEYSIZE, it->second.first);
+    auto clhashFunction = it->second.second;
+
+    alignas(32) unsigned char buf[64] = {0};
+    std::vector<unsigned char> input = benchmark_verus_hash_input();
+    verus_hash_v2(buf, &input[0], input.size());
+
+    u128 *key = CVerusHashV2::GenNewCLKey(buf);
+    __m128i **pMoveScratch = vclh.getpmovescratch(vclh.gethasherrefresh());
+    uint64_t intermediate = 0;
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        *(uint64_t *)(buf + 32) = intermediate + i;
+        intermediate = (*clhashFunction)(key, buf, vclh.keyMask, pMoveScratch);
+        vclh.gethashkey();
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_verusclhash_threaded(const std::string &variant, int nThreads)
+{
+    return benchmark_threaded(std::bind(&benchmark_verusclhash, variant), nThreads);
+}
+
+double benchmark_haraka512(bool portable)
+{
+    alignas(32) unsigned char buf[64] = {0};
+    alignas(32) unsigned char out[32];
+    void (*harakaFunction)(unsigned char *out, const unsigned char *in) = portable ? &haraka512_port : &haraka512;
+    if (portable) {
+        load_constants_port();
+    }
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        *(int *)buf = i;
+        (*harakaFunction)(out, buf);
+        memcpy(buf + 32, out, 32);
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_haraka512_threaded(bool portable, int nThreads)
+{
+    return benchmark_threaded(std::bind(&benchmark_haraka512, portable), nThreads);
+}
+
+double benchmark_haraka256(bool portable)
+{
+    alignas(32) unsigned char buf[32] = {0};
+    void (*harakaFunction)(unsigned char *out, const unsigned char *in) = portable ? &haraka256_port : &haraka256;
+    if (portable) {
+        load_constants_port();
+    }
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < VERUSHASH_BENCHMARK_ITERATIONS; i++) {
+        (*harakaFunction)(buf, buf);
+    }
+    return timer_stop(tv_start);
+}
+
+std::vector<double> benchmark_haraka256_threaded(bool portable, int nThreads)
+{
+    return benchmark_threaded(std::bind(&benchmark_haraka256, portable), nThreads);
+}
+
 double benchmark_large_tx(size_t nInputs)
 {
     // Create priv/pub key
@@ -291,6 +475,38 @@ double benchmark_large_tx(size_t nInputs)
     return timer_stop(tv_start);
 }
 
+// Times the CCurrencyValueMap arithmetic and comparison operators on maps of nCurrencies
+// currencies, half of them shared between the two operands, as in reserve and fee accounting.
+double benchmark_currency_value_map(size_t nCurrencies)
+{
+    std::vector<uint160> currencies;
+    for (size_t i = 0; i < nCurrencies + (nCurrencies >> 1); i++) {
+        currencies.push_back(Hash160(std::vector<unsigned char>(1, (unsigned char)i)));
+    }
+
+    CCurrencyValueMap a, b;
+    for (size_t i = 0; i < nCurrencies; i++) {
+        a.valueMap[currencies[i]] = 100000000 + i;
+        b.valueMap[currencies[i + (nCurrencies >> 1)]] = 10000 + i;
+    }
+
+    CCurrencyValueMap total;
+    int64_t nCompared = 0;
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    for (int i = 0; i < CURRENCY_VALUE_MAP_BENCHMARK_ITERATIONS; i++) {
+        CCurrencyValueMap sum = a + b;
+        CCurrencyValueMap difference = sum - b;
+        total += difference;
+        total -= a;
+        nCompared += (difference == a) + (b <= sum) + (a < sum);
+    }
+    double duration = timer_stop(tv_start);
+    assert(nCompared == 3 * CURRENCY_VALUE_MAP_BENCHMARK_ITERATIONS || !nCurrencies);
+    return duration;
+}
+
 // The two benchmarks, try_decrypt_sprout_notes and try_decrypt_sapling_notes,
 // are checking worst-case scenarios. In both we add n keys to a wallet, 
 // create a transaction using a key not in our original list of n, and then
@@ -315,7 +531,7 @@ double benchmark_try_decrypt_sprout_notes(size_t nKeys)
     return timer_stop(tv_start);
 }
 
-double benchmark_try_decrypt_sapling_notes(size_t nKeys)
+double benchmark_try_decrypt_sapling_notes(size_t nKeys, int nThreads)
 {
     // Set params
     auto consensusParams = Params().GetConsensus();
@@ -335,7 +551,8 @@ double benchmark_try_decrypt_sapling_notes(size_t nKeys)
 
     struct timeval tv_start;
     timer_start(tv_start);
-    auto noteDataMapAndAddressesToAdd = wallet.FindMySaplingNotes(tx);
+    auto noteDataMapAndAddressesToAdd = wallet.FindMySaplingNotes(tx,
+        CWallet::TrialDecryptSaplingOutputs(tx, wallet.GetSaplingIncomingViewingKeys(), nThreads));
     assert(noteDataMapAndAddressesToAdd.first.empty());
     return timer_stop(tv_start);
 }
@@ -3,6 +3,12 @@
 
 #include <sys/time.h>
 #include <stdlib.h>
+#include <string>
+
+// number of hashes timed in each sample of the VerusHash benchmarks
+static const int VERUSHASH_BENCHMARK_ITERATIONS = 100000;
+// number of operator rounds timed in each sample of the currency value map benchmark
+static const int CURRENCY_VALUE_MAP_BENCHMARK_ITERATIONS = 100000;
 
 extern double benchmark_sleep();
 extern double benchmark_parameter_loading();
@@ -12,9 +18,23 @@ extern double benchmark_solve_equihash();
 extern std::vector<double> benchmark_solve_equihash_threaded(int nThreads);
 extern double benchmark_verify_joinsplit(const JSDescription &joinsplit);
 extern double benchmark_verify_equihash();
+extern double benchmark_verus_hash();
+extern std::vector<double> benchmark_verus_hash_threaded(int nThreads);
+extern double benchmark_verus_hash_v2();
+extern std::vector<double> benchmark_verus_hash_v2_threaded(int nThreads);
+extern double benchmark_verus_hash_v2b();
+extern std::vector<double> benchmark_verus_hash_v2b_threaded(int nThreads);
+extern bool benchmark_verusclhash_supported(const std::string &variant);
+extern double benchmark_verusclhash(const std::string &variant);
+extern std::vector<double> benchmark_verusclhash_threaded(const std::string &variant, int nThreads);
+extern double benchmark_haraka512(bool portable);
+extern std::vector<double> benchmark_haraka512_threaded(bool portable, int nThreads);
+extern double benchmark_haraka256(bool portable);
+extern std::vector<double> benchmark_haraka256_threaded(bool portable, int nThreads);
 extern double benchmark_large_tx(size_t nInputs);
+extern double benchmark_currency_value_map(size_t nCurrencies);
 extern double benchmark_try_decrypt_sprout_notes(size_t nAddrs);
-extern double benchmark_try_decrypt_sapling_notes(size_t nAddrs);
+extern double benchmark_try_decrypt_sapling_notes(size_t nAddrs, int nThreads);
 extern double benchmark_increment_sprout_note_witnesses(size_t nTxs);
 extern double benchmark_increment_sapling_note_witnesses(size_t nTxs);
 extern double benchmark_connectblock_slow();